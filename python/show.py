@@ -1,8 +1,53 @@
+import sys
+import struct
 import pandas as pd
 import matplotlib.pyplot as plt
 
-# Fixed file path (change if necessary)
+# Fixed file path (change if necessary), or given on the command line:
+#   python show.py [file] [column]
 filepath = "/Users/avass/Documents/1SSE/Code/FishingVillage/data/economicdatas.csv"
+if len(sys.argv) > 1:
+    filepath = sys.argv[1]
+
+# Metric pyramid (*.pyr, written with pyramidPath): read only the level that fits the
+# screen, which also works while the run is still writing the file.
+#   python show.py run.pyr [series] [first_cycle] [last_cycle]
+if filepath.endswith(".pyr"):
+    screen_points = 2000
+    with open(filepath, "rb") as f:
+        magic, version, n_series, n_levels, _, capacity = struct.unpack("<8sIIIIQ", f.read(32))
+        names = [f.read(32).split(b"\0")[0].decode() for _ in range(n_series)]
+        levels = [struct.unpack("<QQQ", f.read(24)) for _ in range(n_levels)]
+        series = sys.argv[2] if len(sys.argv) > 2 else "DailyGDP"
+        s_index = names.index(series)
+        first = int(sys.argv[3]) if len(sys.argv) > 3 else 0
+        last = int(sys.argv[4]) if len(sys.argv) > 4 else capacity
+        level = 0
+        while level + 1 < n_levels and ((last - first) >> level) > screen_points:
+            level += 1
+        offset, _, written = levels[level]
+        b0, b1 = first >> level, min((last + (1 << level) - 1) >> level, written)
+        cycles, lows, highs, means, picks_x, picks_y = [], [], [], [], [], []
+        for b in range(b0, b1):
+            f.seek(offset + (b * n_series + s_index) * 48)
+            lo, hi, mean, _, pick_cycle, pick_value = struct.unpack("<6d", f.read(48))
+            cycles.append(((b << level) + 1) + ((1 << level) - 1) / 2)
+            lows.append(lo)
+            highs.append(hi)
+            means.append(mean)
+            picks_x.append(pick_cycle + 1)
+            picks_y.append(pick_value)
+    plt.figure(figsize=(10, 6))
+    plt.fill_between(cycles, lows, highs, alpha=0.3, label="min-max")
+    plt.plot(picks_x, picks_y, label=series, linewidth=1)
+    plt.plot(cycles, means, label="mean", linewidth=1, linestyle="--")
+    plt.xlabel("Cycle")
+    plt.ylabel(series)
+    plt.title(f"{series} (level {level}: {1 << level} cycles per point)")
+    plt.legend()
+    plt.grid(True)
+    plt.show()
+    sys.exit(0)
 
 # Load the data and clean column names
 df = pd.read_csv(filepath)
@@ -10,7 +55,14 @@ df.columns = df.columns.str.strip()  # Remove any extra spaces from column names
 
 # Define the x-axis and y-axis parameters
 x_parameter = "Cycle"         # x-axis is always the cycle
-y_parameter = "DailyGDP"     # change this to "DailyGDP", "Population", etc.
+y_parameter = "DailyGDP"     # change this to "DailyGDP", "Population", "Gini", "PriceCV", etc.
+if len(sys.argv) > 2:
+    y_parameter = sys.argv[2]
+
+# Output of the catalog query tool (query.exe): plot the mean with its quantile band.
+quantile_columns = [c for c in df.columns if c.startswith("Q") and c[1:].isdigit()]
+if "Mean" in df.columns and len(sys.argv) <= 2:
+    y_parameter = "Mean"
 
 # Downsampling configuration: use step=1 for full data, or change to e.g., 100 for every 100th row
 downsample_step = 1  # Change to 100, 10, etc. if you want to reduce the number of points
@@ -22,6 +74,10 @@ if downsample_step > 1:
 # Plotting
 plt.figure(figsize=(10, 6))
 plt.plot(df[x_parameter], df[y_parameter], label=y_parameter, linewidth=2)
+if y_parameter == "Mean" and len(quantile_columns) >= 2:
+    quantile_columns.sort(key=lambda c: int(c[1:]))
+    low, high = quantile_columns[0], quantile_columns[-1]
+    plt.fill_between(df[x_parameter], df[low], df[high], alpha=0.3, label=f"{low}-{high}")
 plt.xlabel(x_parameter)
 plt.ylabel(y_parameter)
 plt.title(f"Time Series of {y_parameter}")
@@ -3,19 +3,21 @@
 
 #include <iostream>
 #include <random>
+#include "Money.h"
 
 class Agent {
 protected:
     int ID;               // Unique identifier
-    double funds;         // Available money
+    money_t funds;        // Available money
     bool status;          // true = active, false = inactive
     int age;              // Current age (in cycles)
     int lifetime;         // Maximum lifespan (in cycles)
+    int account;          // Bank account (-1 = none, see DepositBank.h)
     
 public:
     // Constructor: lifetime is drawn from a Gaussian distribution externally
     Agent(int id, double initFunds, int lifetime)
-        : ID(id), funds(initFunds), status(true), age(0), lifetime(lifetime) {}
+        : ID(id), funds(toMoney(initFunds)), status(true), age(0), lifetime(lifetime), account(-1) {}
         
     virtual ~Agent() {}
 
@@ -45,8 +47,14 @@ public:
 
     // Getters
     int getID() const { return ID; }
-    double getFunds() const { return funds; }
+    money_t getFunds() const { return funds; }
+    void setFunds(money_t f) { funds = f; }
+    int getAge() const { return age; }
+    void setAge(int a) { age = a; }
+    int getLifetime() const { return lifetime; }
     bool isActive() const { return status; }
+    int getAccount() const { return account; }
+    void setAccount(int a) { account = a; }
 };
 
 #endif // AGENT_H
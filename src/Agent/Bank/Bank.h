@@ -0,0 +1,349 @@
+#ifndef BANK_H
+#define BANK_H
+
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include "Agent.h"
+#include "Executor.h"
+
+// Double-entry ledger used by the bank agents.
+//
+// Accounts are dense indices into structure-of-arrays storage (deposit balance,
+// outstanding loan, state), so tens of millions of them fit in memory and a
+// settlement streams through it. Money moves only through payments queued during
+// the cycle; each one debits the payer and credits the payee by the same amount,
+// and no balance changes before settle() runs at the end of the day:
+//   1) each payment becomes two postings (payer -, payee +), which are scattered
+//      stably into blocks of accounts (count, prefix sum, scatter, in parallel
+//      over the payments);
+//   2) each block is netted and swept by one thread: postings are summed in payment
+//      order, overdrafts become loans, interest accrues, part of each loan is repaid
+//      and closed accounts are swept into the bank's own account;
+//   3) the per-block totals are reduced in block order.
+// Neither the blocks nor the posting order depend on the thread count, so the
+// balances are bit-identical for any number of threads, with double money too.
+//
+// Net money (balances minus loans) changes only through external flows:
+// endowments, imports and emigrants. Debug builds check this after every settlement.
+
+enum class PaymentKind : uint8_t {
+    Transfer,   // Any other payment
+    Wage,       // Employer to employee
+    Purchase,   // Buyer to seller
+    Loan        // Disbursement: the payee's deposit and loan both grow
+};
+
+// Totals of one settlement.
+struct SettlementReport {
+    size_t payments = 0;
+    money_t gross = money_t();            // Sum of the payment amounts
+    money_t net = money_t();              // Sum of the positive net changes of the accounts
+    money_t newLoans = money_t();         // Overdrafts converted into loans, and disbursements
+    money_t repaid = money_t();           // Loan principal repaid
+    money_t depositInterest = money_t();  // Paid by the bank to depositors
+    money_t loanInterest = money_t();     // Charged by the bank to borrowers
+    money_t writtenOff = money_t();       // Loans of closed accounts
+    money_t deposits = money_t();         // Customer balances after settlement
+    money_t loans = money_t();            // Outstanding loans after settlement
+    money_t equity = money_t();           // Balance of the bank's own account
+};
+
+class Ledger {
+public:
+    typedef uint32_t Account;
+    static constexpr Account external = 0xffffffffu;  // Outside the ledger
+    static constexpr Account bankAccount = 0;         // The bank's own account
+    static constexpr size_t blockSize = 1 << 14;      // Accounts netted by one task
+
+private:
+    enum State : uint8_t { Free, Open, Closing, Leaving };
+
+    // One side of a payment, as scattered into its account block.
+    struct Posting {
+        Account account;
+        uint32_t loan;      // 1 if the posting also moves the loan (disbursement)
+        money_t delta;
+    };
+
+    std::vector<money_t> balance;
+    std::vector<money_t> loan;
+    std::vector<uint8_t> state;
+    std::vector<Account> freeAccounts;
+
+    // Payments queued for the next settlement.
+    std::vector<Account> payer;
+    std::vector<Account> payee;
+    std::vector<money_t> amount;
+    std::vector<PaymentKind> kind;
+
+    std::vector<Posting> postings;   // Scratch space, kept between settlements
+    money_t inflow;                  // External inflow since the last settlement
+    money_t netMoney;                // Balances minus loans after the last settlement
+    Executor executor;               // Runs the settlement's chunks (see Executor.h)
+
+public:
+    Ledger() : inflow(), netMoney() {
+        balance.push_back(money_t());
+        loan.push_back(money_t());
+        state.push_back(Open);
+    }
+
+    // Open an account, funded with `initial` from outside the ledger.
+    Account open(money_t initial = money_t()) {
+        Account a;
+        if (!freeAccounts.empty()) {
+            a = freeAccounts.back();
+            freeAccounts.pop_back();
+            state[a] = Open;
+        } else {
+            a = static_cast<Account>(balance.size());
+            balance.push_back(money_t());
+            loan.push_back(money_t());
+            state.push_back(Open);
+        }
+        if (initial != money_t())
+            deposit(a, initial);
+        return a;
+    }
+
+    // Close an account at the next settlement. Its balance goes to the bank, or
+    // leaves the ledger if `leaving` (emigration); the bank writes its loan off.
+    void close(Account a, bool leaving = false) {
+        if (a < state.size() && state[a] == Open && a != bankAccount)
+            state[a] = leaving ? Leaving : Closing;
+    }
+
+    void pay(Account from, Account to, money_t value, PaymentKind k = PaymentKind::Transfer) {
+        payer.push_back(from);
+        payee.push_back(to);
+        amount.push_back(value);
+        kind.push_back(k);
+    }
+
+    // Money entering (value > 0) or leaving (value < 0) the ledger.
+    void deposit(Account a, money_t value) {
+        pay(external, a, value);
+    }
+
+    // The bank lends `value` to an account.
+    void lend(Account a, money_t value) {
+        pay(external, a, value, PaymentKind::Loan);
+    }
+
+    money_t getBalance(Account a) const { return balance[a]; }
+    money_t getLoan(Account a) const { return loan[a]; }
+    size_t size() const { return balance.size(); }
+    size_t getQueued() const { return amount.size(); }
+    money_t getNetMoney() const { return netMoney; }
+    void setExecutor(Executor e) { executor = std::move(e); }
+
+    // Settle the queued payments. Rates are per day; `repayment` is the share of
+    // min(balance, loan) repaid each day; threads <= 0 uses every core.
+    SettlementReport settle(double depositRate, double loanRate, double repayment, int threads) {
+        const size_t accounts = balance.size();
+        const size_t blocks = (accounts + blockSize - 1) / blockSize;
+        const size_t n = amount.size();
+        size_t workers = threads > 0 ? static_cast<size_t>(threads)
+                                     : std::max<size_t>(1, std::thread::hardware_concurrency());
+        workers = std::max<size_t>(1, std::min(workers, std::max(blocks, n / blockSize)));
+
+        SettlementReport report;
+        report.payments = n;
+
+        // 1) Count the postings of each chunk of payments per block, then scatter them.
+        std::vector<size_t> counts(workers * blocks + 1, 0);
+        auto chunk = [&](size_t w, size_t &begin, size_t &end) {
+            begin = n * w / workers;
+            end = n * (w + 1) / workers;
+        };
+        auto count = [&](size_t w) {
+            size_t begin, end;
+            chunk(w, begin, end);
+            size_t *c = &counts[w * blocks];
+            for (size_t i = begin; i < end; i++) {
+                if (payer[i] != external)
+                    c[payer[i] / blockSize]++;
+                if (payee[i] != external)
+                    c[payee[i] / blockSize]++;
+            }
+        };
+        runChunks(executor, workers, count);
+        // Block-major prefix sum: block b, chunk w starts after every earlier block and
+        // the earlier chunks of block b, so postings keep the payment order.
+        std::vector<size_t> start(workers * blocks + 1, 0);
+        size_t total = 0;
+        std::vector<size_t> blockStart(blocks + 1, 0);
+        for (size_t b = 0; b < blocks; b++) {
+            blockStart[b] = total;
+            for (size_t w = 0; w < workers; w++) {
+                start[w * blocks + b] = total;
+                total += counts[w * blocks + b];
+            }
+        }
+        blockStart[blocks] = total;
+        postings.resize(total);
+        auto scatter = [&](size_t w) {
+            size_t begin, end;
+            chunk(w, begin, end);
+            size_t *next = &start[w * blocks];
+            for (size_t i = begin; i < end; i++) {
+                uint32_t disbursement = kind[i] == PaymentKind::Loan ? 1u : 0u;
+                if (payer[i] != external)
+                    postings[next[payer[i] / blockSize]++] = {payer[i], 0u, -amount[i]};
+                if (payee[i] != external)
+                    postings[next[payee[i] / blockSize]++] = {payee[i], disbursement, amount[i]};
+            }
+        };
+        runChunks(executor, workers, scatter);
+
+        // 2) Net and sweep each block.
+        struct BlockTotals {
+            money_t net, newLoans, repaid, depositInterest, loanInterest, writtenOff;
+            money_t deposits, loans, toBank, leaving;
+            std::vector<Account> freed;
+        };
+        std::vector<BlockTotals> totals(blocks);
+        auto sweep = [&](size_t w) {
+            for (size_t b = blocks * w / workers; b < blocks * (w + 1) / workers; b++) {
+                BlockTotals &t = totals[b];
+                size_t lo = b * blockSize, hi = std::min(accounts, lo + blockSize);
+                std::vector<money_t> change(hi - lo, money_t());
+                for (size_t p = blockStart[b]; p < blockStart[b + 1]; p++) {
+                    const Posting &post = postings[p];
+                    change[post.account - lo] += post.delta;
+                    if (post.loan) {
+                        loan[post.account] += post.delta;
+                        t.newLoans += post.delta;
+                    }
+                }
+                for (size_t a = lo; a < hi; a++) {
+                    money_t c = change[a - lo];
+                    balance[a] += c;
+                    if (c > money_t())
+                        t.net += c;
+                    if (a == bankAccount)
+                        continue;
+                    if (state[a] == Free) {
+                        // A payment to an account closed earlier goes to the bank.
+                        t.toBank += balance[a];
+                        balance[a] = money_t();
+                        continue;
+                    }
+                    if (state[a] != Open) {
+                        if (state[a] == Leaving)
+                            t.leaving += balance[a];
+                        else
+                            t.toBank += balance[a];
+                        t.toBank -= loan[a];
+                        t.writtenOff += loan[a];
+                        balance[a] = money_t();
+                        loan[a] = money_t();
+                        state[a] = Free;
+                        t.freed.push_back(static_cast<Account>(a));
+                        continue;
+                    }
+                    if (balance[a] < money_t()) {
+                        loan[a] -= balance[a];
+                        t.newLoans -= balance[a];
+                        balance[a] = money_t();
+                    }
+                    if (loan[a] > money_t()) {
+                        money_t interest = loan[a] * loanRate;
+                        loan[a] += interest;
+                        t.loanInterest += interest;
+                        t.toBank += interest;
+                    }
+                    if (balance[a] > money_t()) {
+                        money_t interest = balance[a] * depositRate;
+                        balance[a] += interest;
+                        t.depositInterest += interest;
+                        t.toBank -= interest;
+                        if (loan[a] > money_t()) {
+                            money_t r = std::min(balance[a], loan[a]) * repayment;
+                            balance[a] -= r;
+                            loan[a] -= r;
+                            t.repaid += r;
+                        }
+                    }
+                    t.deposits += balance[a];
+                    t.loans += loan[a];
+                }
+            }
+        };
+        runChunks(executor, workers, sweep);
+
+        // 3) Reduce in block order.
+        money_t toBank = money_t(), leaving = money_t();
+        for (size_t b = 0; b < blocks; b++) {
+            const BlockTotals &t = totals[b];
+            report.net += t.net;
+            report.newLoans += t.newLoans;
+            report.repaid += t.repaid;
+            report.depositInterest += t.depositInterest;
+            report.loanInterest += t.loanInterest;
+            report.writtenOff += t.writtenOff;
+            report.deposits += t.deposits;
+            report.loans += t.loans;
+            toBank += t.toBank;
+            leaving += t.leaving;
+            freeAccounts.insert(freeAccounts.end(), t.freed.begin(), t.freed.end());
+        }
+        balance[bankAccount] += toBank;
+        report.equity = balance[bankAccount];
+        for (size_t i = 0; i < n; i++) {
+            report.gross += amount[i];
+            if (payer[i] == external && kind[i] != PaymentKind::Loan)
+                inflow += amount[i];
+        }
+        inflow -= leaving;
+
+        money_t expected = netMoney + inflow;
+        netMoney = report.deposits + report.equity - report.loans;
+#ifdef debug
+        // Conservation of money: nothing but external flows may change net money.
+        double error = std::fabs(toDouble(netMoney) - toDouble(expected));
+        double scale = toDouble(report.gross) + toDouble(report.deposits) + toDouble(report.loans)
+                     + std::fabs(toDouble(report.equity));
+        if (error > 1e-9 * scale + 1e-6)
+            std::cerr << "Error: Ledger settlement does not conserve money (expected " << expected
+                      << ", got " << netMoney << ")\n";
+#else
+        (void)expected;
+#endif
+        inflow = money_t();
+        payer.clear();
+        payee.clear();
+        amount.clear();
+        kind.clear();
+        return report;
+    }
+};
+
+// Common base of the bank agents: an agent that sets an annual interest rate.
+class Bank : public Agent {
+protected:
+    double interestRate;   // Annual rate (policy rate or lending rate)
+
+public:
+    Bank(int id, double rate)
+        : Agent(id, 0.0, 100000000), interestRate(rate)
+    {}
+
+    virtual ~Bank() {}
+
+    double getInterestRate() const { return interestRate; }
+    void setInterestRate(double rate) { interestRate = rate; }
+
+    virtual void print() const override {
+        Agent::print();
+#if verbose==1
+        std::cout << "Interest Rate: " << interestRate * 100 << "%" << std::endl;
+#endif
+    }
+};
+
+#endif // BANK_H
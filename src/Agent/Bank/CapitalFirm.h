@@ -0,0 +1,87 @@
+#ifndef CAPITALFIRM_H
+#define CAPITALFIRM_H
+
+#include <string>
+#include <algorithm>
+#include "Firm.h"
+
+// Capital goods sold to the fishing firms.
+enum class CapitalGood : int {
+    Boat = 0,
+    Net = 1
+};
+
+inline const char *capitalGoodName(CapitalGood good) {
+    return good == CapitalGood::Boat ? "boat" : "net";
+}
+
+// A firm producing one capital good (boats or nets) for the fishing firms, through
+// the production network (see ProductionNetwork.h). Its stock is its inventory of
+// finished goods: act() adds one day of production, up to five days' worth. Each
+// delivered unit adds fishYield fish to the buyer's stock. The price moves with the
+// demand pressure of the day: up 1% when orders exceed the inventory, down 0.5%
+// when less than half of it is ordered (never below a fifth of the initial price).
+class CapitalFirm : public Firm {
+private:
+    CapitalGood good;
+    double capacity;     // Units produced per day
+    double fishYield;    // Fish added to the buyer's stock per delivered unit
+    money_t minPrice;
+
+public:
+    CapitalFirm(int id, double initFunds, CapitalGood good_, double price, double capacity_, double fishYield_)
+        : Firm(id, initFunds, 100000000, 0, capacity_, price, 0.0, 0.0),
+          good(good_),
+          capacity(capacity_),
+          fishYield(fishYield_),
+          minPrice(toMoney(0.2 * price))
+    {}
+
+    virtual ~CapitalFirm() {}
+
+    // Daily production.
+    virtual void act() override {
+        stock = std::min(stock + capacity, 5.0 * capacity);
+    }
+
+    // Deliver `units` out of the `ordered` units requested today.
+    void sell(double units, double ordered) {
+        units = std::min(units, stock);
+        if (units > 0.0) {
+            stock -= units;
+            addSale(priceLevel, units);
+        }
+        if (ordered > units + stock)
+            priceLevel = priceLevel * 1.01;
+        else if (ordered < 0.5 * (units + stock))
+            priceLevel = std::max(priceLevel * 0.995, minPrice);
+    }
+
+    CapitalGood getGood() const { return good; }
+    double getCapacity() const { return capacity; }
+    double getFishYield() const { return fishYield; }
+
+    // Capital firms do not hire fishermen.
+    virtual JobPosting generateJobPosting(const std::string &sector, int eduReq, int expReq, int attract) const override {
+        JobPosting posting;
+        posting.firmID = getID();
+        posting.jobSector = sector;
+        posting.educationRequirement = eduReq;
+        posting.experienceRequirement = expReq;
+        posting.attractiveness = attract;
+        posting.vacancies = 0;
+        posting.recruiting = false;
+        return posting;
+    }
+
+    virtual void print() const override {
+        Firm::print();
+#if verbose==1
+        std::cout << "Capital Good: " << capitalGoodName(good)
+                  << " | Capacity: " << capacity
+                  << " | Fish Yield: " << fishYield << std::endl;
+#endif
+    }
+};
+
+#endif // CAPITALFIRM_H
@@ -0,0 +1,97 @@
+#ifndef CENTRALBANK_H
+#define CENTRALBANK_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "Bank.h"
+
+// Central bank: sets the policy rate with a Taylor rule.
+//
+// Every day it observes the clearing fish price and the unemployment rate. The price
+// is smoothed (exponential moving average of its log, ~30-day half-life) because the
+// daily price is very noisy, and annual inflation is the change of the smoothed log
+// price over the last year (scaled up during the first year). Every meetingInterval
+// days the policy rate becomes
+//     neutral + inflation + 0.5 (inflation - target) - 0.5 (unemployment - target),
+// floored at zero.
+class CentralBank : public Bank {
+private:
+    double neutralRate;          // Real rate with inflation and unemployment on target
+    double inflationTarget;      // Annual
+    double unemploymentTarget;   // Fraction of the population
+    int meetingInterval;         // Days between two rate decisions
+
+    double logPriceTrend;               // Smoothed log fish price
+    std::vector<double> trendHistory;   // Last year of logPriceTrend, as a ring
+    size_t observed;                    // Days observed
+    double inflation;                   // Annual inflation estimate
+    double unemployment;                // Last observed unemployment rate
+
+public:
+    CentralBank(int id, double neutral, double inflationTarget_, double unemploymentTarget_,
+                int meetingInterval_, int daysPerYear = 365)
+        : Bank(id, neutral + inflationTarget_),
+          neutralRate(neutral),
+          inflationTarget(inflationTarget_),
+          unemploymentTarget(unemploymentTarget_),
+          meetingInterval(std::max(meetingInterval_, 1)),
+          logPriceTrend(0.0),
+          trendHistory(static_cast<size_t>(std::max(daysPerYear, 1)), 0.0),
+          observed(0),
+          inflation(inflationTarget_),
+          unemployment(unemploymentTarget_)
+    {}
+
+    virtual ~CentralBank() {}
+
+    void setTargets(double neutral, double inflationTarget_, double unemploymentTarget_, int meetingInterval_) {
+        neutralRate = neutral;
+        inflationTarget = inflationTarget_;
+        unemploymentTarget = unemploymentTarget_;
+        meetingInterval = std::max(meetingInterval_, 1);
+    }
+
+    // Record one day's fish price and unemployment rate (fraction).
+    void observe(double price, double unemploymentRate) {
+        unemployment = unemploymentRate;
+        if (price <= 0.0)
+            return;
+        const double alpha = 1.0 - std::exp(std::log(0.5) / 30.0);
+        double logPrice = std::log(price);
+        logPriceTrend = observed == 0 ? logPrice : logPriceTrend + alpha * (logPrice - logPriceTrend);
+        size_t year = trendHistory.size();
+        if (observed >= year) {
+            inflation = std::exp(logPriceTrend - trendHistory[observed % year]) - 1.0;
+        } else if (observed > 0) {
+            double elapsed = static_cast<double>(observed);
+            inflation = std::exp((logPriceTrend - trendHistory[0]) * static_cast<double>(year) / elapsed) - 1.0;
+        }
+        trendHistory[observed % year] = logPriceTrend;
+        observed++;
+    }
+
+    // Rate decision on meeting days.
+    virtual void act() override {
+        if (observed == 0 || observed % static_cast<size_t>(meetingInterval) != 0)
+            return;
+        double rate = neutralRate + inflation
+                    + 0.5 * (inflation - inflationTarget)
+                    - 0.5 * (unemployment - unemploymentTarget);
+        interestRate = std::max(rate, 0.0);
+    }
+
+    double getPolicyRate() const { return interestRate; }
+    double getInflation() const { return inflation; }
+
+    virtual void print() const override {
+        Bank::print();
+#if verbose==1
+        std::cout << "Policy Rate: " << interestRate * 100 << "%"
+                  << " | Inflation (annual): " << inflation * 100 << "%"
+                  << " | Unemployment: " << unemployment * 100 << "%" << std::endl;
+#endif
+    }
+};
+
+#endif // CENTRALBANK_H
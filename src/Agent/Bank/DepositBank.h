@@ -0,0 +1,82 @@
+#ifndef DEPOSITBANK_H
+#define DEPOSITBANK_H
+
+#include <algorithm>
+#include "Bank.h"
+#include "TaskAccess.h"
+
+// Deposit bank: keeps every agent's account in its ledger and settles the day's
+// payments. Its rates follow the central bank's policy rate: deposits earn
+// policy - depositSpread (at least 0) and loans cost policy + loanSpread. An account
+// that ends the day overdrawn is lent the difference, and each day a borrower with a
+// positive balance repays a share (loanRepayment) of what it can. The bank's funds
+// are the balance of its own account (interest margin minus written-off loans).
+class DepositBank : public Bank {
+private:
+    Ledger ledger;
+    double policyRate;
+    double depositSpread;
+    double loanSpread;
+    double loanRepayment;
+    int settlementThreads;
+    SettlementReport lastSettlement;
+
+public:
+    DepositBank(int id, double policyRate_, double depositSpread_, double loanSpread_,
+                double loanRepayment_, int settlementThreads_ = 1)
+        : Bank(id, policyRate_ + loanSpread_),
+          policyRate(policyRate_),
+          depositSpread(depositSpread_),
+          loanSpread(loanSpread_),
+          loanRepayment(loanRepayment_),
+          settlementThreads(settlementThreads_)
+    {}
+
+    virtual ~DepositBank() {}
+
+    Ledger &getLedger() {
+        TaskAccess::touch(this, true);
+        return ledger;
+    }
+    const Ledger &getLedger() const { return ledger; }
+
+    void setPolicyRate(double rate) {
+        policyRate = rate;
+        interestRate = rate + loanSpread;
+    }
+
+    void setTerms(double depositSpread_, double loanSpread_, double loanRepayment_, int settlementThreads_) {
+        depositSpread = depositSpread_;
+        loanSpread = loanSpread_;
+        loanRepayment = loanRepayment_;
+        settlementThreads = settlementThreads_;
+        interestRate = policyRate + loanSpread;
+    }
+
+    double getDepositRate() const { return std::max(policyRate - depositSpread, 0.0); }
+    double getLoanRate() const { return interestRate; }
+
+    // End-of-day settlement of every queued payment.
+    virtual void act() override {
+        lastSettlement = ledger.settle(getDepositRate() / 365.0, getLoanRate() / 365.0,
+                                       loanRepayment, settlementThreads);
+        funds = lastSettlement.equity;
+    }
+
+    const SettlementReport &getLastSettlement() const { return lastSettlement; }
+
+    virtual void print() const override {
+        Bank::print();
+#if verbose==1
+        std::cout << "Payments: " << lastSettlement.payments
+                  << " | Gross: " << lastSettlement.gross
+                  << " | Net: " << lastSettlement.net
+                  << " | Deposits: " << lastSettlement.deposits
+                  << " | Loans: " << lastSettlement.loans
+                  << " | New Loans: " << lastSettlement.newLoans
+                  << " | Repaid: " << lastSettlement.repaid << std::endl;
+#endif
+    }
+};
+
+#endif // DEPOSITBANK_H
@@ -7,10 +7,11 @@
 #include <algorithm>
 #include <vector>
 #include "JobMarket.h"  // For JobPosting struct
+#include "MemoryAccounting.h"
 
 // Structure to record each sale transaction.
 struct SaleRecord {
-    double salePrice;
+    money_t salePrice;
     double quantity;
 };
 
@@ -18,14 +19,17 @@ class Firm : public Agent {
 protected:
     int numberOfEmployees;    // Number of workers employed by the firm
     double stock;             // Current product inventory (in fish units)
-    double priceLevel;        // Offered price per fish (e.g., ~5.1 pounds)
+    money_t priceLevel;       // Offered price per fish (e.g., ~5.1 pounds)
     double salesEfficiency;   // Sales efficiency factor (units each employee can sell)
     double jobPostMultiplier; // Multiplier for number of job posts
-    double wageExpense;       // Computed as numberOfEmployees * clearing wage
+    money_t wageExpense;      // Computed as numberOfEmployees * clearing wage
+    int networkRow;           // Row in the production network (-1 = none)
+    double investmentDraw;    // Uniform draw for the next investment (< 0 = draw from rand())
 
     // Tracking actual sales.
-    double totalRevenue;                  // Accumulated revenue from sales
-    std::vector<SaleRecord> sales;        // List of sale transactions
+    money_t totalRevenue;                 // Accumulated revenue from sales
+    money_t lastRevenue;                  // Revenue of the last completed day
+    TrackedVector<SaleRecord, MemoryTag::Sales> sales;  // List of sale transactions
 
 public:
     // Constructor with parameters.
@@ -35,64 +39,86 @@ public:
          : Agent(id, initFunds, lifetime),
            numberOfEmployees(numberOfEmployees),
            stock(stock),
-           priceLevel(priceLevel),
+           priceLevel(toMoney(priceLevel)),
            salesEfficiency(salesEfficiency),
            jobPostMultiplier(jobPostMultiplier),
-           wageExpense(0.0),
-           totalRevenue(0.0)
+           wageExpense(),
+           networkRow(-1),
+           investmentDraw(-1.0),
+           totalRevenue(),
+           lastRevenue()
     {}
 
     virtual ~Firm() {}
 
     // Revenue is based on actual sales.
-    virtual double calculateRevenue() const {
+    virtual money_t calculateRevenue() const {
          return totalRevenue;
     }
 
     // Record a sale: update revenue and log the sale.
-    void addSale(double salePrice, double quantity) {
-         double saleValue = salePrice * quantity;
+    void addSale(money_t salePrice, double quantity) {
+         money_t saleValue = salePrice * quantity;
          totalRevenue += saleValue;
          sales.push_back({salePrice, quantity});
     }
 
     // Reset sales records and revenue.
     void resetSales() {
-         totalRevenue = 0.0;
+         lastRevenue = totalRevenue;
+         totalRevenue = money_t();
          sales.clear();
     }
 
-    void setWageExpense(double clearingWage) {
-         wageExpense = numberOfEmployees * clearingWage;
+    void setWageExpense(money_t clearingWage) {
+         wageExpense = clearingWage * numberOfEmployees;
     }
 
-    virtual double calculateProfit() const {
+    virtual money_t calculateProfit() const {
          return calculateRevenue() - wageExpense;
     }
 
-    virtual double investmentExpenditure() const {
-         double profit = calculateProfit();
-         if (profit <= 0)
-             return 0;
-         double s = static_cast<double>(rand()) / RAND_MAX;
+    // Profit of the last completed day (sales are reset before firms act).
+    money_t getLastProfit() const {
+         return lastRevenue - wageExpense;
+    }
+
+    virtual money_t investmentExpenditure() const {
+         money_t profit = calculateProfit();
+         if (profit <= money_t())
+             return money_t();
+         double s = investmentDraw >= 0.0 ? investmentDraw : static_cast<double>(rand()) / RAND_MAX;
          return profit * (1.0 - s);
     }
 
+    // Supply the uniform draw of the next investment (common random numbers).
+    void setInvestmentDraw(double u) { investmentDraw = u; }
+
     // Modified calculateFishProduced() forces stock to be an integer (whole fish)
-    virtual double calculateFishProduced() const {
+    virtual money_t calculateFishProduced() const {
          // Compute the quantity of fish produced as the minimum of the available stock and twice the number of employees.
          double fishQuantity = std::min(stock, 2.0 * static_cast<double>(numberOfEmployees));
          return fishQuantity * priceLevel;
     }
 
-    // In act(), revenue is determined solely by recorded sales.
-    virtual void act() override {
-         double invest = investmentExpenditure();
-         stock += invest;
+    // Turn part of the profit into stock.
+    void invest() {
+         money_t invest = investmentExpenditure();
+         stock += toDouble(invest);
          // Ensure stock never goes negative.
          stock = std::max(stock, 0.0);
-         // Update funds with revenue minus wage expenses.
+    }
+
+    // Update funds with revenue minus wage expenses.
+    void bookProfit() {
          funds += calculateRevenue() - wageExpense;
+    }
+
+    // In act(), revenue is determined solely by recorded sales.
+    // With banking or a production network, the World runs the two halves itself.
+    virtual void act() override {
+         invest();
+         bookProfit();
          // Optionally, you might reset sales here if tracking per cycle.
          // resetSales();
     }
@@ -128,8 +154,8 @@ public:
     double getStock() const { return stock; }
     void setStock(double s) { stock = s; }
 
-    double getPriceLevel() const { return priceLevel; }
-    void setPriceLevel(double p) { priceLevel = p; }
+    money_t getPriceLevel() const { return priceLevel; }
+    void setPriceLevel(money_t p) { priceLevel = p; }
 
     double getSalesEfficiency() const { return salesEfficiency; }
     void setSalesEfficiency(double se) { salesEfficiency = se; }
@@ -137,7 +163,10 @@ public:
     double getJobPostMultiplier() const { return jobPostMultiplier; }
     void setJobPostMultiplier(double jpm) { jobPostMultiplier = jpm; }
 
-    virtual double getRevenue() const { return calculateRevenue(); }
+    virtual money_t getRevenue() const { return calculateRevenue(); }
+
+    int getNetworkRow() const { return networkRow; }
+    void setNetworkRow(int r) { networkRow = r; }
     
     // Pure virtual function; derived classes must implement it.
     virtual JobPosting generateJobPosting(const std::string &sector, int eduReq, int expReq, int attract) const = 0;
@@ -9,7 +9,7 @@
 class FisherMan : public Household {
 protected:
     bool employed;               // Employment status in the fishing industry
-    double wage;                 // Daily wage when employed (set later via job matching)
+    money_t wage;                // Daily wage when employed (set later via job matching)
     // In our village model, unemployed fishermen receive no income
     // (we omit unemploymentBenefit here for simplicity)
     
@@ -22,15 +22,22 @@ protected:
     int jobPreference;           // Minimum acceptable job attractiveness (1-5)
                                // This single number represents the worker's preference threshold.
 
+    int daysWithoutEat;          // Consecutive days without buying a fish
+
+    // Position in the employer index (maintained by EmploymentIndex).
+    int employerSlot;            // Slot of the employing firm, -1 when unemployed
+    size_t employerPosition;     // Position in that firm's worker array
+
 public:
     FisherMan(int id, double initFunds, int lifetime, double income, double savings,
               double jobDemand, double goodsDemand, bool employed, double wage,
               double unemploymentBenefit, 
               const std::string &jobSector, int educationLevel, int experienceLevel, int jobPreference)
         : Household(id, initFunds, lifetime, income, savings, jobDemand, goodsDemand),
-          employed(employed), wage(wage),
+          employed(employed), wage(toMoney(wage)),
           jobSector(jobSector), educationLevel(educationLevel),
-          experienceLevel(experienceLevel), jobPreference(jobPreference)
+          experienceLevel(experienceLevel), jobPreference(jobPreference),
+          daysWithoutEat(0), employerSlot(-1), employerPosition(0)
     {}
 
     virtual ~FisherMan() {}
@@ -39,10 +46,13 @@ public:
     // Unemployed fishermen receive no income.
     virtual void act() override {
         if (employed) {
-            funds += wage;
+            creditWage();
         }
     }
 
+    // Non-virtual wage credit used by the per-firm payroll pass.
+    void creditWage() { funds += wage; }
+
     virtual void print() const override {
         Household::print();
 #if verbose
@@ -86,8 +96,20 @@ public:
     bool isEmployed() const { return employed; }
     void setEmployed(bool e) { employed = e; }
 
-    double getWage() const { return wage; }
-    void setWage(double w) { wage = w; }
+    money_t getWage() const { return wage; }
+    void setWage(money_t w) { wage = w; }
+
+    int getDaysWithoutEat() const { return daysWithoutEat; }
+    void setDaysWithoutEat(int days) { daysWithoutEat = days; }
+    // Reset the starvation counter after a meal, otherwise count one more day without eating.
+    void recordMeal(bool ate) { daysWithoutEat = ate ? 0 : daysWithoutEat + 1; }
+
+    int getEmployerSlot() const { return employerSlot; }
+    size_t getEmployerPosition() const { return employerPosition; }
+    void setEmployerSlot(int slot, size_t position) {
+        employerSlot = slot;
+        employerPosition = position;
+    }
 };
 
 #endif // FISHERMAN_H
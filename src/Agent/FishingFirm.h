@@ -2,6 +2,7 @@
 #define FISHINGFIRM_H
 
 #include "Firm.h"
+#include "PerishableStock.h"
 #include <algorithm>
 #include <iostream>
 #include <cmath>      // For std::floor
@@ -14,14 +15,19 @@
 struct FishOffering {
     int id;
     std::string productSector;
-    double cost;
-    double offeredPrice;
+    money_t cost;
+    money_t offeredPrice;
     double quantity;
+    int age = 0;            // Freshness tier: days since the fish was caught
     std::shared_ptr<class FishingFirm> firm;
 };
 #endif
 
 class FishingFirm : public Firm {
+private:
+    PerishableStock catchStock;   // Unsold catch by age (empty = unsold fish is discarded)
+    double importedFish = 0.0;    // Bought from other villages, offered at the next clearing
+
 public:
     // Constructor: priceLevel is fixed at 6.0.
     // We no longer use jobPostMultiplier.
@@ -44,13 +50,49 @@ public:
         FishOffering offer;
         offer.id = getID();
         offer.productSector = "fishing";
-        offer.cost = cost;
+        offer.cost = toMoney(cost);
         offer.offeredPrice = getPriceLevel();
         offer.quantity = getGoodsSupply();
         // The 'firm' field will be set externally.
         return offer;
     }
 
+    // Keep unsold fish for up to `days` days (0 = discard it at the end of the day).
+    void setShelfLife(int days) { catchStock = PerishableStock(days); }
+    int getShelfLife() const { return catchStock.getShelfLife(); }
+
+    // Perishable catch: land today's catch, sell from a freshness tier, and age the
+    // stock at the end of the day (returns the quantity spoiled).
+    void landCatch(double quantity) { catchStock.add(quantity); }
+    double getFreshStock(int tier) const { return catchStock.at(static_cast<size_t>(tier)); }
+    double getHeldCatch() const { return catchStock.total(); }
+    void takeFromCatch(int tier, double quantity) { catchStock.take(static_cast<size_t>(tier), quantity); }
+    double ageCatch() { return catchStock.age(); }
+
+    // Regional trade. Exports leave the perishable stock, oldest fish first, and return
+    // the quantity shipped. Imports are landed in the perishable stock when there is
+    // one; otherwise they are held for the next day's import offering.
+    double exportCatch(double quantity) {
+        double shipped = 0.0;
+        for (int a = getShelfLife() - 1; a >= 0 && shipped < quantity; a--) {
+            double q = std::min(quantity - shipped, getFreshStock(a));
+            takeFromCatch(a, q);
+            shipped += q;
+        }
+        return shipped;
+    }
+    void importCatch(double quantity) {
+        if (catchStock.enabled())
+            catchStock.add(quantity);
+        else
+            importedFish += quantity;
+    }
+    double takeImports() {
+        double q = importedFish;
+        importedFish = 0.0;
+        return q;
+    }
+
     // Generate a job posting.
     virtual JobPosting generateJobPosting(const std::string &sector, int eduReq, int expReq, int attract) const override {
         JobPosting posting;
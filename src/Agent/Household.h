@@ -6,14 +6,14 @@
 
 class Household : public Agent {
 protected:
-    double income;      // Earnings (wages or dividends)
-    double savings;     // Accumulated wealth
+    money_t income;     // Earnings (wages or dividends)
+    money_t savings;    // Accumulated wealth
     double jobDemand;   // Indicator/quantity for job seeking
     double goodsDemand; // Quantity of goods desired
 
 public:
     Household(int id, double initFunds, int lifetime, double income, double savings, double jobDemand, double goodsDemand)
-        : Agent(id, initFunds, lifetime), income(income), savings(savings), jobDemand(jobDemand), goodsDemand(goodsDemand) {}
+        : Agent(id, initFunds, lifetime), income(toMoney(income)), savings(toMoney(savings)), jobDemand(jobDemand), goodsDemand(goodsDemand) {}
 
     virtual ~Household() {}
 
@@ -27,11 +27,11 @@ public:
     }
 
     // Getters and Setters
-    double getIncome() const { return income; }
-    void setIncome(double inc) { income = inc; }
+    money_t getIncome() const { return income; }
+    void setIncome(money_t inc) { income = inc; }
 
-    double getSavings() const { return savings; }
-    void setSavings(double s) { savings = s; }
+    money_t getSavings() const { return savings; }
+    void setSavings(money_t s) { savings = s; }
 
     double getJobDemand() const { return jobDemand; }
     void setJobDemand(double jd) { jobDemand = jd; }
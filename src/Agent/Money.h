@@ -0,0 +1,72 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+
+// Currency representation used by agents and markets (money_t).
+//
+// By default money is a plain double. Building with -DFIXED_MONEY (make FIXED_MONEY=1)
+// switches to Money, a 64-bit integer count of sub-pence units (1/100 of a penny).
+// Sums of Money are exact and independent of summation order, so parallel
+// reductions give bit-identical results and balances do not drift over long runs.
+// Products with a double (price * quantity) are rounded to the nearest unit.
+// Code converts at the boundaries with toMoney() and toDouble(), which are the
+// identity in the double build.
+
+class Money {
+public:
+    static constexpr int64_t unitsPerPound = 10000;
+
+    Money() : units(0) {}
+
+    static Money fromUnits(int64_t u) { Money m; m.units = u; return m; }
+    static Money fromDouble(double value) {
+        return fromUnits(static_cast<int64_t>(std::llround(value * unitsPerPound)));
+    }
+
+    int64_t getUnits() const { return units; }
+    double toDouble() const { return static_cast<double>(units) / unitsPerPound; }
+
+    Money &operator+=(Money o) { units += o.units; return *this; }
+    Money &operator-=(Money o) { units -= o.units; return *this; }
+    Money &operator*=(double f) { *this = *this * f; return *this; }
+
+    friend Money operator+(Money a, Money b) { return fromUnits(a.units + b.units); }
+    friend Money operator-(Money a, Money b) { return fromUnits(a.units - b.units); }
+    friend Money operator-(Money a) { return fromUnits(-a.units); }
+    friend Money operator*(Money a, double f) {
+        return fromUnits(static_cast<int64_t>(std::llround(static_cast<double>(a.units) * f)));
+    }
+    friend Money operator*(double f, Money a) { return a * f; }
+    friend Money operator*(Money a, int n) { return fromUnits(a.units * n); }
+    friend Money operator*(int n, Money a) { return fromUnits(a.units * n); }
+    friend Money operator/(Money a, double d) {
+        return fromUnits(static_cast<int64_t>(std::llround(static_cast<double>(a.units) / d)));
+    }
+
+    friend bool operator==(Money a, Money b) { return a.units == b.units; }
+    friend bool operator!=(Money a, Money b) { return a.units != b.units; }
+    friend bool operator<(Money a, Money b) { return a.units < b.units; }
+    friend bool operator>(Money a, Money b) { return a.units > b.units; }
+    friend bool operator<=(Money a, Money b) { return a.units <= b.units; }
+    friend bool operator>=(Money a, Money b) { return a.units >= b.units; }
+
+    friend std::ostream &operator<<(std::ostream &os, Money m) { return os << m.toDouble(); }
+
+private:
+    int64_t units;
+};
+
+#ifdef FIXED_MONEY
+typedef Money money_t;
+inline money_t toMoney(double value) { return Money::fromDouble(value); }
+inline double toDouble(money_t value) { return value.toDouble(); }
+#else
+typedef double money_t;
+inline money_t toMoney(double value) { return value; }
+inline double toDouble(money_t value) { return value; }
+#endif
+
+#endif // MONEY_H
@@ -0,0 +1,71 @@
+#ifndef PERISHABLESTOCK_H
+#define PERISHABLESTOCK_H
+
+#include <vector>
+#include <algorithm>
+
+// Fish kept for sale, bucketed by age in days (0 = caught today).
+//
+// The buckets form a ring of shelfLife slots and `head` is the slot of age 0, so
+// the bucket of age a is buckets[(head + a) % shelfLife]. Ageing moves the head
+// back by one: the oldest slot becomes the new (empty) age-0 slot and whatever it
+// held spoils. Adding, selling, ageing and the total are O(1); listing the tiers
+// is O(shelfLife).
+class PerishableStock {
+private:
+    std::vector<double> buckets;
+    size_t head;
+    double held;
+
+    size_t slot(size_t age) const { return (head + age) % buckets.size(); }
+
+public:
+    explicit PerishableStock(int shelfLife = 0)
+        : buckets(static_cast<size_t>(std::max(shelfLife, 0)), 0.0), head(0), held(0.0)
+    {}
+
+    int getShelfLife() const { return static_cast<int>(buckets.size()); }
+    bool enabled() const { return !buckets.empty(); }
+    double total() const { return held; }
+
+    double at(size_t age) const { return age < buckets.size() ? buckets[slot(age)] : 0.0; }
+
+    // Today's catch.
+    void add(double quantity) {
+        if (buckets.empty() || quantity <= 0.0)
+            return;
+        buckets[head] += quantity;
+        held += quantity;
+    }
+
+    // Remove sold fish from the bucket of the given age.
+    void take(size_t age, double quantity) {
+        if (age >= buckets.size() || quantity <= 0.0)
+            return;
+        double &b = buckets[slot(age)];
+        quantity = std::min(quantity, b);
+        b -= quantity;
+        held -= quantity;
+    }
+
+    // End of day: everything gets one day older and the oldest bucket spoils.
+    // Returns the quantity spoiled.
+    double age() {
+        if (buckets.empty())
+            return 0.0;
+        head = (head + buckets.size() - 1) % buckets.size();
+        double spoiled = buckets[head];
+        buckets[head] = 0.0;
+        held -= spoiled;
+        if (held < 0.0)
+            held = 0.0;
+        return spoiled;
+    }
+
+    void clear() {
+        std::fill(buckets.begin(), buckets.end(), 0.0);
+        held = 0.0;
+    }
+};
+
+#endif // PERISHABLESTOCK_H
@@ -1,15 +1,11 @@
 #ifndef FISHINGMARKET_H
 #define FISHINGMARKET_H
 
-#include "Market.h"
+#include "GoodsMarket.h"
 #include "FishingFirm.h"  // Complete definition of FishingFirm is now available.
-#include <vector>
 #include <string>
-#include <algorithm>
 #include <iostream>
-#include <random>
 #include <memory>
-#include <unordered_map>   // for tracking individual purchases
 
 // Structure for FishOffering (if not defined elsewhere)
 #ifndef FISH_OFFERING_DEFINED
@@ -17,9 +13,10 @@
 struct FishOffering {
     int id;
     std::string productSector;
-    double cost;
-    double offeredPrice;
+    money_t cost;
+    money_t offeredPrice;
     double quantity;
+    int age = 0;            // Freshness tier: days since the fish was caught
     std::shared_ptr<FishingFirm> firm;
 };
 #endif
@@ -28,121 +25,54 @@ struct FishOrder {
     int id;
     std::string desiredSector;
     double quantity;
-    double perceivedValue;
+    money_t perceivedValue;
     bool hungry;            // true if the fisherman has not eaten for at least one day
-    double availableFunds;  // funds available at order creation
+    money_t availableFunds; // funds available at order creation
 };
 
+// Traits of fish for the market engine (see GoodsMarket.h): indivisible (an order
+// buys its whole quantity from one firm), perishable (sales come out of the offer's
+// freshness tier), sold by firms to fishermen who pay up to their perceived value,
+// or up to their funds when hungry.
+struct FishGood {
+    using Offer = FishOffering;
+    using Order = FishOrder;
+    static constexpr MemoryTag tag = MemoryTag::FishMarket;
+    static constexpr bool perishable = true;
+    static constexpr bool divisible = false;
+
+    static money_t reservationPrice(const FishOrder &order) {
+        return order.hungry ? order.availableFunds : order.perceivedValue;
+    }
+    static bool sameSector(const FishOrder &order, const FishOffering &off) {
+        return order.desiredSector == off.productSector;
+    }
+    static void sold(const FishOffering &off, double quantity) {
+        if (off.firm)
+            off.firm->addSale(off.offeredPrice, quantity);
+    }
+    static void takeFromTier(const FishOffering &off, double quantity) {
+        if (off.firm)
+            off.firm->takeFromCatch(off.age, quantity);
+    }
+    static int sellerAccount(const FishOffering &off) {
+        return off.firm ? off.firm->getAccount() : -1;
+    }
+};
 
-
-class FishingMarket : public Market {
-private:
-    std::vector<FishOffering> offerings;
-    std::vector<FishOrder> orders;
-    double aggregateSupply = 0.0;
-    double aggregateDemand = 0.0;
-    double matchedVolume;
-    
-    // NEW: Track individual purchases: fisherID -> totalQuantityBought in this cycle.
-    std::unordered_map<int, double> purchases;
-
+// The village's fish market: the market engine instantiated for fish.
+class FishingMarket : public GoodsMarket<FishGood> {
 public:
     FishingMarket(double initialClearingPrice = 5.0)
-        : Market(initialClearingPrice), matchedVolume(0.0)
+        : GoodsMarket<FishGood>(initialClearingPrice)
     {}
 
     virtual ~FishingMarket() {}
 
     double getClearingFishPrice() const { return clearingPrice; }
-    double getAggregateSupply() const { return aggregateSupply; }
-    double getAggregateDemand() const { return aggregateDemand; }
 
-    void submitFishOffering(const FishOffering& offering) {
-        offerings.push_back(offering);
-        aggregateSupply += offering.quantity;
-    }
-
-    void submitFishOrder(const FishOrder& order) {
-        orders.push_back(order);
-        aggregateDemand += order.quantity;
-    }
-
-    // NEW: Return a mapping of fisherID to total purchased quantity.
-    const std::unordered_map<int, double>& getPurchases() const {
-        return purchases;
-    }
-
-    virtual void clearMarket(std::default_random_engine &generator) override {
-    // Clear the purchase tracking for this cycle.
-    purchases.clear();
-
-    matchedVolume = 0.0;
-    double sumTransactionValue = 0.0;
-    double totalTransactionVolume = 0.0;
-
-    // Iterate through each order.
-    for (auto &order : orders) {
-        // For each order, search for a matching offering.
-        for (auto &off : offerings) {
-            if (order.desiredSector == off.productSector) {
-                // First check: if the fisherman is hungry.
-                if (order.hungry) {
-                    // Accept the offer if he has enough funds to pay the offered price,
-                    // regardless of his perceived price.
-                    if (order.availableFunds >= off.offeredPrice && order.quantity >= 1 && off.quantity >= order.quantity) {
-                        double transacted = order.quantity;  // transaction for the entire requested quantity
-                        order.quantity -= transacted;
-                        off.quantity -= transacted;
-                        matchedVolume += transacted;
-                        totalTransactionVolume += transacted;
-                        sumTransactionValue += off.offeredPrice * transacted;
-                        // Record the purchase for this fisherman.
-                        purchases[order.id] += transacted;
-                        if (off.firm) {
-                            off.firm->addSale(off.offeredPrice, transacted);
-                        }
-                        // Once the order is satisfied, move to the next order.
-                        break;
-                    }
-                } else {
-                    // If not hungry, use the normal condition: perceived price must be high enough.
-                    if (order.perceivedValue >= off.offeredPrice && order.quantity >= 1 && off.quantity >= order.quantity) {
-                        double transacted = order.quantity;
-                        order.quantity -= transacted;
-                        off.quantity -= transacted;
-                        matchedVolume += transacted;
-                        totalTransactionVolume += transacted;
-                        sumTransactionValue += off.offeredPrice * transacted;
-                        purchases[order.id] += transacted;
-                        if (off.firm) {
-                            off.firm->addSale(off.offeredPrice, transacted);
-                        }
-                        break;
-                    }
-                }
-            }
-        }
-    }
-    
-    if (totalTransactionVolume > 0) {
-        clearingPrice = sumTransactionValue / totalTransactionVolume;
-    }
-    aggregateSupply = 0.0;
-    aggregateDemand = 0.0;
-}
-
-    // NEW: Reset function to clear orders (and offerings) at the end of the cycle.
-    virtual void reset() override {
-        // Call base class reset (if necessary).
-        Market::reset();
-        // Clear the vectors so orders from previous cycles don't accumulate.
-        offerings.clear();
-        orders.clear();
-        aggregateSupply = 0.0;
-        aggregateDemand = 0.0;
-        // Optionally, reset matchedVolume.
-        matchedVolume = 0.0;
-    }
+    void submitFishOffering(const FishOffering& offering) { submitOffering(offering); }
+    void submitFishOrder(const FishOrder& order) { submitOrder(order); }
 
     virtual void print() const override {
 #if verbose==1
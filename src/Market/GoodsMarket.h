@@ -0,0 +1,422 @@
+#ifndef GOODSMARKET_H
+#define GOODSMARKET_H
+
+#include "Market.h"
+#include "Money.h"
+#include "QuantileSketch.h"
+#include "MemoryAccounting.h"
+#include "ModelPolicy.h"
+#include "TaskAccess.h"
+#include "Executor.h"
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <functional>
+#include <cmath>
+
+// Market engine for one good, specialised at compile time by the good's traits.
+//
+// Every good gets its own instantiation, so a village with several products (fish
+// species, freshness grades) has one market per product: no sector strings and no
+// virtual calls between the orders and the offerings. Good provides:
+//   Offer, Order              the book's layouts; an offer has offeredPrice and
+//                             quantity, an order has quantity
+//   tag                       MemoryTag charged for the book
+//   perishable                sales are taken from the offer's freshness tier
+//   divisible                 an order may be filled in part and by several sellers;
+//                             otherwise it buys its whole quantity from one seller
+//   reservationPrice(order)   acceptance rule: the order buys at any offered price
+//                             up to it
+//   sameSector(order, offer)  read only when the model policy allows several sectors
+//   sold(offer, quantity)     credit the seller
+//   takeFromTier(offer, q)    (perishable goods) take the sold units from the stock
+//   sellerAccount(offer)      bank account paid for the sale (-1 = none)
+// Each clearing kernel is a template on Good and on the model policy (ModelPolicy.h),
+// so the acceptance test, the fill rule and the sale hooks are inlined into the
+// matching loop.
+template <class Good>
+class GoodsMarket : public Market {
+public:
+    using Offer = typename Good::Offer;
+    using Order = typename Good::Order;
+
+protected:
+    static constexpr MemoryTag tag = Good::tag;
+
+    // Per-thread state of one partition of the order book during parallel clearing.
+    struct Partition {
+        size_t begin = 0;                       // First order index of the partition
+        size_t end = 0;                         // One past the last order index
+        TrackedVector<double, tag> stockLeft;   // Remaining share of each offering
+        TrackedVector<double, tag> sold;        // Quantity sold from each offering
+        TrackedVector<size_t, tag> blocked;     // Orders that only lacked allocated stock
+    };
+
+    TrackedVector<Offer, tag> offerings;
+    TrackedVector<Order, tag> orders;
+    double matchedVolume;
+
+    // Quantity bought by each order of the last clearing, indexed like the orders.
+    // Kept after reset() so the World can run its starvation check.
+    TrackedVector<double, tag> orderFills;
+    TrackedVector<money_t, tag> orderSpend;  // What each order paid
+    TrackedVector<int, tag> orderSellers;    // Bank account of the seller each order last bought from (-1 = none)
+    double unsoldVolume = 0.0;   // Units left on offer after the last clearing
+    double unmetDemand = 0.0;    // Units ordered but not bought in the last clearing
+
+    int clearingThreads = 1;  // Partitions used by clearMarket (1 = serial)
+    // Runs the partitions (nullptr = one std::thread per partition but the first).
+    Executor executor;
+    TrackedVector<money_t, tag> unitPrices;  // Scratch of clearUnitOrders
+    TrackedVector<double, tag> unitLeft;
+
+    // Transaction prices of the last clearing, weighted by quantity (kept after reset()).
+    QuantileSketch priceSketch;
+    double priceSquares = 0.0;   // Sum of quantity * price^2
+
+    // Matching rule shared by the serial and partitioned clearing paths: the order's
+    // reservation price must cover the offered price, and the offering must hold the
+    // whole order (indivisible goods; one unit under unitOrders) or anything at all
+    // (divisible goods).
+    template <class Model>
+    static bool accepts(const Order &order, const Offer &off, double available) {
+        if constexpr (!Model::singleSector) {
+            if (!Good::sameSector(order, off))
+                return false;
+        }
+        bool willing = Good::reservationPrice(order) >= off.offeredPrice;
+        if constexpr (Good::divisible)
+            return willing && order.quantity > 0.0 && available > 0.0;
+        else if constexpr (Model::unitOrders)
+            return willing && available >= 1;
+        else
+            return willing && order.quantity >= 1 && available >= order.quantity;
+    }
+
+    // Quantity an accepted order takes from an offering holding `available`.
+    static double take(const Order &order, double available) {
+        if constexpr (Good::divisible)
+            return std::min(order.quantity, available);
+        else
+            return order.quantity;  // The entire requested quantity
+    }
+
+    // Whether an order that just bought is done (an indivisible order always is).
+    static bool satisfied(const Order &order) {
+        if constexpr (Good::divisible)
+            return !(order.quantity > 0.0);
+        else
+            return true;
+    }
+
+    // Partitioned clearing. Orders are split into contiguous partitions and every
+    // offering's quantity is pre-allocated to partitions with a prefix sum over the
+    // partitions' demand, so each thread matches against its own inventory without
+    // locking. Seller sales are then merged in partition order, and orders
+    // that were only blocked by an exhausted allocation are retried serially against
+    // the pooled leftovers. Results depend on the partition count, never on timing.
+    template <class Model>
+    void clearPartitioned(size_t partitions, money_t &sumTransactionValue, double &totalTransactionVolume) {
+        const size_t nOff = offerings.size();
+        TrackedVector<Partition, tag> parts(partitions);
+
+        // Contiguous order ranges and their demand prefix sums.
+        TrackedVector<double, tag> demandPrefix(partitions + 1, 0.0);
+        for (size_t p = 0; p < partitions; p++) {
+            parts[p].begin = orders.size() * p / partitions;
+            parts[p].end = orders.size() * (p + 1) / partitions;
+            double demand = 0.0;
+            for (size_t i = parts[p].begin; i < parts[p].end; i++)
+                demand += orders[i].quantity;
+            demandPrefix[p + 1] = demandPrefix[p] + demand;
+        }
+        const double totalDemand = demandPrefix[partitions];
+
+        // Partition p receives floor(Q * D[p+1] / D) - floor(Q * D[p] / D) whole units of each
+        // offering; the fractional remainder goes to the last partition so shares sum to Q.
+        for (size_t p = 0; p < partitions; p++) {
+            parts[p].stockLeft.assign(nOff, 0.0);
+            parts[p].sold.assign(nOff, 0.0);
+        }
+        for (size_t j = 0; j < nOff; j++) {
+            double q = std::max(offerings[j].quantity, 0.0);
+            double allocated = 0.0;
+            for (size_t p = 0; p < partitions; p++) {
+                double upTo = (p + 1 == partitions || totalDemand <= 0.0)
+                              ? q
+                              : std::floor(q * demandPrefix[p + 1] / totalDemand);
+                parts[p].stockLeft[j] = upTo - allocated;
+                allocated = upTo;
+            }
+        }
+
+        runChunks(executor, partitions, [this, &parts](size_t p) { clearPartition<Model>(parts[p]); });
+
+        // Deterministic merge in partition order.
+        TrackedVector<double, tag> leftover(nOff, 0.0);
+        for (auto &part : parts) {
+            for (size_t j = 0; j < nOff; j++) {
+                leftover[j] += part.stockLeft[j];
+                if (part.sold[j] > 0.0) {
+                    recordSale(offerings[j], part.sold[j], sumTransactionValue, totalTransactionVolume);
+                }
+            }
+        }
+
+        // Residual pass over orders that found a willing seller with no allocation left.
+        for (auto &part : parts) {
+            for (size_t i : part.blocked) {
+                auto &order = orders[i];
+                for (size_t j = 0; j < nOff; j++) {
+                    if (accepts<Model>(order, offerings[j], leftover[j])) {
+                        double transacted = take(order, leftover[j]);
+                        order.quantity -= transacted;
+                        leftover[j] -= transacted;
+                        fillOrder(i, offerings[j], transacted);
+                        recordSale(offerings[j], transacted, sumTransactionValue, totalTransactionVolume);
+                        if (satisfied(order))
+                            break;
+                    }
+                }
+            }
+        }
+        for (size_t j = 0; j < nOff; j++)
+            offerings[j].quantity = leftover[j];
+    }
+
+    // Match one partition's orders against its own share of each offering.
+    template <class Model>
+    void clearPartition(Partition &part) {
+        for (size_t i = part.begin; i < part.end; i++) {
+            Order &order = orders[i];
+            bool blocked = false;
+            bool filled = false;
+            for (size_t j = 0; j < offerings.size(); j++) {
+                const Offer &off = offerings[j];
+                if (accepts<Model>(order, off, part.stockLeft[j])) {
+                    double transacted = take(order, part.stockLeft[j]);
+                    order.quantity -= transacted;
+                    part.stockLeft[j] -= transacted;
+                    part.sold[j] += transacted;
+                    fillOrder(i, off, transacted);  // partitions own disjoint order ranges
+                    if (satisfied(order)) {
+                        filled = true;
+                        break;
+                    }
+                    // A divisible order emptied this share and still wants more: the
+                    // offering may have stock left in other partitions' shares.
+                    if (off.quantity > part.stockLeft[j] + part.sold[j])
+                        blocked = true;
+                    continue;
+                }
+                if (!blocked && accepts<Model>(order, off, off.quantity))
+                    blocked = true;  // willing seller, but this partition's share ran out
+            }
+            if (!filled && blocked)
+                part.blocked.push_back(i);
+        }
+    }
+
+    // Serial clearing of single-sector, one-unit orders of an indivisible good (see
+    // ModelPolicy.h). Each order takes the first offering whose price it accepts and
+    // that still holds a whole unit, as in the general loop, but prices and quantities
+    // are scanned from two dense arrays, the reservation price is read once per order,
+    // and the scan starts after the leading offerings with less than one unit left,
+    // which cannot sell again.
+    void clearUnitOrders(money_t &sumTransactionValue, double &totalTransactionVolume) {
+        const size_t nOff = offerings.size();
+        unitPrices.resize(nOff);
+        unitLeft.resize(nOff);
+        for (size_t j = 0; j < nOff; j++) {
+            unitPrices[j] = offerings[j].offeredPrice;
+            unitLeft[j] = offerings[j].quantity;
+        }
+        size_t first = 0;
+        for (size_t i = 0; i < orders.size(); i++) {
+            while (first < nOff && !(unitLeft[first] >= 1))
+                first++;
+            Order &order = orders[i];
+            money_t limit = Good::reservationPrice(order);
+            for (size_t j = first; j < nOff; j++) {
+                if (limit >= unitPrices[j] && unitLeft[j] >= 1) {
+                    order.quantity -= 1.0;
+                    unitLeft[j] -= 1.0;
+                    recordSale(offerings[j], 1.0, sumTransactionValue, totalTransactionVolume);
+                    fillOrder(i, offerings[j], 1.0);
+                    break;
+                }
+            }
+        }
+        for (size_t j = 0; j < nOff; j++)
+            offerings[j].quantity = unitLeft[j];
+    }
+
+    // Serial clearing: each order, in submission order, buys from the offerings in
+    // submission order.
+    template <class Model>
+    void clearSerial(money_t &sumTransactionValue, double &totalTransactionVolume) {
+        for (size_t i = 0; i < orders.size(); i++) {
+            Order &order = orders[i];
+            for (auto &off : offerings) {
+                if (accepts<Model>(order, off, off.quantity)) {
+                    double transacted = take(order, off.quantity);
+                    order.quantity -= transacted;
+                    off.quantity -= transacted;
+                    recordSale(off, transacted, sumTransactionValue, totalTransactionVolume);
+                    fillOrder(i, off, transacted);
+                    if (satisfied(order))
+                        break;
+                }
+            }
+        }
+    }
+
+    // Record what order i bought from an offering.
+    void fillOrder(size_t i, const Offer &off, double quantity) {
+        orderFills[i] += quantity;
+        orderSpend[i] += off.offeredPrice * quantity;
+        orderSellers[i] = Good::sellerAccount(off);
+    }
+
+    void recordSale(const Offer &off, double quantity,
+                    money_t &sumTransactionValue, double &totalTransactionVolume) {
+        matchedVolume += quantity;
+        totalTransactionVolume += quantity;
+        sumTransactionValue += off.offeredPrice * quantity;
+        double price = toDouble(off.offeredPrice);
+        priceSketch.insert(price, static_cast<uint64_t>(std::llround(quantity)));
+        priceSquares += price * price * quantity;
+        Good::sold(off, quantity);
+        if constexpr (Good::perishable)
+            Good::takeFromTier(off, quantity);
+    }
+
+public:
+    GoodsMarket(double initialClearingPrice)
+        : Market(initialClearingPrice), matchedVolume(0.0)
+    {}
+
+    virtual ~GoodsMarket() {}
+
+    double getUnsoldVolume() const { return unsoldVolume; }
+    double getUnmetDemand() const { return unmetDemand; }
+
+    void submitOffering(const Offer &offering) {
+        TaskAccess::touch(this, true);
+        offerings.push_back(offering);
+        aggregateSupply += offering.quantity;
+    }
+
+    void submitOrder(const Order &order) {
+        TaskAccess::touch(this, true);
+        orders.push_back(order);
+        aggregateDemand += order.quantity;
+    }
+
+    // Quantity bought by each order of the last clearing (in submission order).
+    const TrackedVector<double, tag>& getOrderFills() const {
+        TaskAccess::touch(this, false);
+        return orderFills;
+    }
+
+    // What each order of the last clearing paid, and to which seller's bank account.
+    const TrackedVector<money_t, tag>& getOrderSpend() const {
+        TaskAccess::touch(this, false);
+        return orderSpend;
+    }
+    const TrackedVector<int, tag>& getOrderSellers() const {
+        TaskAccess::touch(this, false);
+        return orderSellers;
+    }
+
+    // Number of partitions (threads) used by clearMarket; 1 keeps the serial loop.
+    void setClearingThreads(int threads) {
+        clearingThreads = std::max(1, threads);
+    }
+    int getClearingThreads() const { return clearingThreads; }
+
+    // Run the partitions through a thread pool instead of one thread each (see
+    // Executor.h). The partition count alone decides the result, so the executor
+    // cannot change it.
+    void setExecutor(Executor e) {
+        executor = std::move(e);
+    }
+
+    // Transaction price distribution of the last clearing.
+    void setSketchAccuracy(size_t k) { priceSketch.setAccuracy(k); }
+    const QuantileSketch& getPriceSketch() const { return priceSketch; }
+    // Coefficient of variation of the transaction prices (0 with no trade).
+    double getPriceDispersion() const {
+        double volume = static_cast<double>(priceSketch.count());
+        if (volume <= 0.0)
+            return 0.0;
+        double mean = priceSketch.total() / volume;
+        double variance = std::max(priceSquares / volume - mean * mean, 0.0);
+        return mean > 0.0 ? std::sqrt(variance) / mean : 0.0;
+    }
+
+    virtual void clearMarket(std::default_random_engine &generator) override {
+        clear<RuntimeModel>(generator);
+    }
+
+    // Clearing specialised for a model policy (see ModelPolicy.h).
+    template <class Model>
+    void clear(std::default_random_engine &generator) {
+        (void)generator;
+        TaskAccess::touch(this, true);
+        // Clear the purchase tracking for this cycle.
+        orderFills.assign(orders.size(), 0.0);
+        orderSpend.assign(orders.size(), money_t());
+        orderSellers.assign(orders.size(), -1);
+        priceSketch.clear();
+        priceSquares = 0.0;
+
+        matchedVolume = 0.0;
+        money_t sumTransactionValue = money_t();
+        double totalTransactionVolume = 0.0;
+
+        size_t partitions = std::min(static_cast<size_t>(clearingThreads), orders.size());
+        if (partitions > 1) {
+            clearPartitioned<Model>(partitions, sumTransactionValue, totalTransactionVolume);
+        } else if constexpr (Model::singleSector && Model::unitOrders && !Good::divisible) {
+            clearUnitOrders(sumTransactionValue, totalTransactionVolume);
+        } else {
+            clearSerial<Model>(sumTransactionValue, totalTransactionVolume);
+        }
+
+        if (totalTransactionVolume > 0) {
+            clearingPrice = toDouble(sumTransactionValue) / totalTransactionVolume;
+        }
+        unsoldVolume = 0.0;
+        for (const auto &off : offerings)
+            unsoldVolume += std::max(off.quantity, 0.0);
+        unmetDemand = 0.0;
+        for (const auto &order : orders)
+            unmetDemand += std::max(order.quantity, 0.0);
+        aggregateSupply = 0.0;
+        aggregateDemand = 0.0;
+    }
+
+    // Clear the orders and offerings at the end of the cycle (the last clearing's
+    // per-order results and price sketch are kept).
+    virtual void reset() override {
+        TaskAccess::touch(this, true);
+        Market::reset();
+        offerings.clear();
+        orders.clear();
+        matchedVolume = 0.0;
+    }
+
+    virtual void print() const override {
+#if verbose==1
+        std::cout << "-----------" << std::endl;
+        Market::print();
+        std::cout << "Matched Volume: " << matchedVolume
+                  << " | Offerings: " << offerings.size()
+                  << " | Orders: " << orders.size() << std::endl;
+#endif
+    }
+};
+
+#endif // GOODSMARKET_H
@@ -2,11 +2,16 @@
 #define JOBMARKET_H
 
 #include "Market.h"
+#include "MemoryAccounting.h"
+#include "ModelPolicy.h"
+#include "TaskAccess.h"
 #include <vector>
 #include <string>
 #include <algorithm>
 #include <iostream>
 #include <random>
+#include <cstdint>
+#include <unordered_map>
 
 struct JobPosting {
     int firmID;
@@ -28,11 +33,36 @@ struct JobApplication {
     bool matched;
 };
 
+// Result of the matching step: which application filled which firm's posting.
+struct JobMatch {
+    size_t application;   // Index of the application in submission order
+    int workerID;
+    int firmID;
+};
+
 class JobMarket : public Market {
 private:
-    std::vector<JobPosting> postings;
-    std::vector<JobApplication> applications;
+    TrackedVector<JobPosting, MemoryTag::JobMarket> postings;
+    TrackedVector<JobApplication, MemoryTag::JobMarket> applications;
+    TrackedVector<JobMatch, MemoryTag::JobMarket> matches;
     int matchedJobs;
+
+    // Matching index. Education, experience, attractiveness and preference are
+    // levels in [1, maxLevel]. Postings are bucketed by (sector, attractiveness)
+    // and, inside that, by (education, experience) requirement; a bit mask per
+    // (sector, attractiveness) marks the requirement buckets that still have
+    // vacancies. The index and scratch buffers are kept between days and only
+    // cleared, so a day's re-matching reuses the previous day's allocations.
+    static constexpr int maxLevel = 5;
+    static constexpr int reqBuckets = maxLevel * maxLevel;
+    struct PostingBucket {
+        std::vector<size_t> postings;  // Indices into postings, in submission order
+        size_t cursor = 0;             // First posting that may still have vacancies
+    };
+    std::unordered_map<std::string, int> sectorIds;  // Interned sector names
+    std::vector<PostingBucket> buckets;              // [sector][attractiveness][edu][exp]
+    std::vector<uint32_t> openMasks;                 // [sector][attractiveness] -> open buckets
+    std::vector<std::vector<size_t>> scoreOrder;     // Applications grouped by skill score
     // New parameters for wage determination based on fish price
     double meanFishOrder;    // Average fish consumption per person (e.g., 1.5)
     double currentFishPrice; // Current price of a fish (e.g., starts at 5)
@@ -56,11 +86,13 @@ public:
     }
 
     void submitJobPosting(const JobPosting &posting) {
+        TaskAccess::touch(this, true);
         postings.push_back(posting);
         aggregateSupply += posting.vacancies;
     }
 
     void submitJobApplication(const JobApplication &application) {
+        TaskAccess::touch(this, true);
         JobApplication app = application;
         app.matched = false;
         applications.push_back(app);
@@ -68,31 +100,88 @@ public:
     }
 
     // clearMarket now focuses on matching jobs and recalculating the wage based on the fish price.
+    //
+    // Matching honours the posting requirements and the applicants' preferences:
+    // an application can fill a posting of the same sector whose education and
+    // experience requirements it meets and whose attractiveness is at least its
+    // preference. Every posting ranks applicants by the same skill score
+    // (education + experience), so worker-proposing deferred acceptance reduces to
+    // serial dictatorship in score order: applicants are taken best first and each
+    // takes the most attractive eligible posting with vacancies left (the most
+    // demanding one on ties, which a less skilled applicant could not fill). The result is
+    // the stable matching, found in O(applications * maxLevel + postings).
     virtual void clearMarket(std::default_random_engine &generator) override {
-        // Process matching between postings and applications.
+        clear<RuntimeModel>(generator);
+    }
+
+    // Matching specialised for a model policy (see ModelPolicy.h). With uniform skills
+    // every applicant has the same score, so score order is submission order and the
+    // counting sort is skipped; with a single sector the sector lookup is skipped.
+    template <class Model>
+    void clear(std::default_random_engine &generator) {
+        (void)generator;
+        TaskAccess::touch(this, true);
         matchedJobs = 0;
-        for (auto &posting : postings) {
-            for (auto &app : applications) {
-                if (!app.matched) {
-                    if (posting.jobSector == app.desiredSector && posting.recruiting) {
-                        posting.vacancies -= 1;
-                        app.matched = true;
-                        matchedJobs++;
-                        if (posting.vacancies <= 0) {
-                            posting.recruiting = false;
-                            break;
-                        }
-                    }
+        matches.clear();
+        buildPostingIndex();
+
+        if constexpr (Model::uniformSkills && Model::singleSector) {
+            if (!sectorIds.empty()) {
+                for (size_t i = 0; i < applications.size(); i++) {
+                    int p = takePosting(0, 1, 1, 1);
+                    if (p < 0)
+                        break;  // No vacancy is left for anyone
+                    applications[i].matched = true;
+                    matches.push_back({i, applications[i].workerID, postings[p].firmID});
+                    matchedJobs++;
                 }
             }
+            clearingPrice = currentFishPrice * meanFishOrder;
+            return;
+        }
+
+        // Counting sort of applications by descending skill score (stable by submission).
+        const int maxScore = 2 * maxLevel;
+        scoreOrder.resize(maxScore + 1);
+        for (auto &group : scoreOrder)
+            group.clear();
+        for (size_t i = 0; i < applications.size(); i++) {
+            const JobApplication &app = applications[i];
+            scoreOrder[level(app.educationLevel) + level(app.experienceLevel)].push_back(i);
+        }
+
+        for (int score = maxScore; score >= 0; score--) {
+            for (size_t i : scoreOrder[score]) {
+                JobApplication &app = applications[i];
+                if (app.matched)
+                    continue;
+                auto sector = sectorIds.find(app.desiredSector);
+                if (sector == sectorIds.end())
+                    continue;
+                int p = takePosting(sector->second, level(app.educationLevel),
+                                    level(app.experienceLevel), level(app.preference));
+                if (p < 0)
+                    continue;
+                app.matched = true;
+                matches.push_back({i, app.workerID, postings[p].firmID});
+                matchedJobs++;
+            }
         }
         // Update the clearing wage based on the current fish price and mean fish order.
         clearingPrice = currentFishPrice * meanFishOrder;
     }
 
+    // Matches made by the last clearMarket(), in the order they were made.
+    const TrackedVector<JobMatch, MemoryTag::JobMarket> &getMatches() const {
+        TaskAccess::touch(this, false);
+        return matches;
+    }
+
     virtual void reset() override {
+        TaskAccess::touch(this, true);
         postings.clear();
         applications.clear();
+        matches.clear();
         aggregateDemand = 0;
         aggregateSupply = 0;
         matchedJobs = 0;
@@ -112,6 +201,76 @@ public:
     }
 
     int getMatchedJobs() const { return matchedJobs; }
+
+private:
+    static int level(int value) {
+        return std::min(std::max(value, 1), maxLevel);
+    }
+
+    // Rebuild the posting buckets for today's postings, reusing yesterday's storage.
+    void buildPostingIndex() {
+        for (const auto &posting : postings) {
+            if (sectorIds.find(posting.jobSector) == sectorIds.end()) {
+                int id = static_cast<int>(sectorIds.size());
+                sectorIds[posting.jobSector] = id;
+            }
+        }
+        size_t nSectors = sectorIds.size();
+        buckets.resize(nSectors * maxLevel * reqBuckets);
+        openMasks.assign(nSectors * maxLevel, 0u);
+        for (auto &bucket : buckets) {
+            bucket.postings.clear();
+            bucket.cursor = 0;
+        }
+        for (size_t i = 0; i < postings.size(); i++) {
+            const JobPosting &posting = postings[i];
+            if (!posting.recruiting || posting.vacancies <= 0)
+                continue;
+            size_t row = static_cast<size_t>(sectorIds[posting.jobSector]) * maxLevel
+                         + static_cast<size_t>(level(posting.attractiveness) - 1);
+            int req = (level(posting.educationRequirement) - 1) * maxLevel
+                      + (level(posting.experienceRequirement) - 1);
+            buckets[row * reqBuckets + static_cast<size_t>(req)].postings.push_back(i);
+            openMasks[row] |= (1u << req);
+        }
+    }
+
+    // Bit mask of the requirement buckets an applicant with this skill satisfies.
+    static uint32_t eligibleMask(int edu, int exp) {
+        uint32_t mask = 0;
+        for (int e = 0; e < edu; e++)
+            for (int x = 0; x < exp; x++)
+                mask |= (1u << (e * maxLevel + x));
+        return mask;
+    }
+
+    // Take one vacancy from the most attractive eligible posting and, among those, from
+    // the one with the highest requirements; returns its index or -1.
+    int takePosting(int sector, int edu, int exp, int preference) {
+        uint32_t eligible = eligibleMask(edu, exp);
+        for (int attract = maxLevel; attract >= preference; attract--) {
+            size_t row = static_cast<size_t>(sector) * maxLevel + static_cast<size_t>(attract - 1);
+            uint32_t open = openMasks[row] & eligible;
+            if (open == 0)
+                continue;
+            // Highest requirement first, leaving the easier postings to the applicants after it.
+            int req = reqBuckets - 1;
+            while (!(open & (1u << req)))
+                req--;
+            PostingBucket &bucket = buckets[row * reqBuckets + static_cast<size_t>(req)];
+            size_t p = bucket.postings[bucket.cursor];
+            JobPosting &posting = postings[p];
+            posting.vacancies -= 1;
+            if (posting.vacancies <= 0) {
+                posting.recruiting = false;
+                bucket.cursor++;
+                if (bucket.cursor == bucket.postings.size())
+                    openMasks[row] &= ~(1u << req);
+            }
+            return static_cast<int>(p);
+        }
+        return -1;
+    }
 };
 
 #endif // JOBMARKET_H
@@ -0,0 +1,237 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Run catalog: one append-only binary file collecting the metric series of many runs.
+//
+//   CatalogFileHeader
+//   run record, run record, ...
+//
+// Each run record is self-describing and 8-byte aligned:
+//   CatalogRunHeader
+//   CatalogParameter[parameters]   name/value pairs (the run's SimulationParameters)
+//   CatalogColumn[columns]         name and offset of each metric block
+//   label                          output path of the run, padded to 8 bytes
+//   double[cycles] per column      columnar metric blocks
+// A reader hops from header to header with recordBytes, so finding runs never reads
+// their metric blocks. Appends take an exclusive flock(), so concurrent runs (forked
+// scenarios, ensembles, MPI villages) can share one catalog.
+
+struct CatalogFileHeader {
+    char magic[8];          // "FVCATLG1"
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct CatalogRunHeader {
+    char magic[8];          // "FVRUNREC"
+    uint64_t recordBytes;   // Size of the whole record, header included
+    uint64_t seed;
+    int64_t timestamp;      // Seconds since the epoch at append time
+    uint32_t cycles;        // Length of every metric block
+    uint32_t columns;
+    uint32_t parameters;
+    uint32_t labelBytes;    // Label length, before padding
+};
+
+struct CatalogParameter {
+    char name[32];
+    double value;
+};
+
+struct CatalogColumn {
+    char name[32];
+    uint64_t offset;        // From the start of the record
+};
+
+// A run to be appended.
+struct CatalogRun {
+    uint64_t seed = 0;
+    std::string label;
+    std::vector<std::pair<std::string, double>> parameters;
+    std::vector<std::pair<std::string, std::vector<double>>> columns;  // All of the same length
+};
+
+namespace catalog {
+
+inline void copyName(char (&dst)[32], const std::string &src) {
+    std::memset(dst, 0, sizeof(dst));
+    std::memcpy(dst, src.data(), std::min(src.size(), sizeof(dst) - 1));
+}
+
+inline size_t pad8(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+} // namespace catalog
+
+class RunCatalog {
+public:
+    // Append one run; returns false if the catalog cannot be written.
+    static bool append(const std::string &path, const CatalogRun &run, int64_t timestamp) {
+        size_t cycles = run.columns.empty() ? 0 : run.columns[0].second.size();
+        size_t head = sizeof(CatalogRunHeader)
+                    + run.parameters.size() * sizeof(CatalogParameter)
+                    + run.columns.size() * sizeof(CatalogColumn)
+                    + catalog::pad8(run.label.size());
+        size_t total = head + run.columns.size() * cycles * sizeof(double);
+        std::vector<char> record(total, 0);
+
+        CatalogRunHeader h;
+        std::memcpy(h.magic, "FVRUNREC", 8);
+        h.recordBytes = total;
+        h.seed = run.seed;
+        h.timestamp = timestamp;
+        h.cycles = static_cast<uint32_t>(cycles);
+        h.columns = static_cast<uint32_t>(run.columns.size());
+        h.parameters = static_cast<uint32_t>(run.parameters.size());
+        h.labelBytes = static_cast<uint32_t>(run.label.size());
+        char *p = record.data();
+        std::memcpy(p, &h, sizeof(h));
+        p += sizeof(h);
+        for (const auto &param : run.parameters) {
+            CatalogParameter cp;
+            catalog::copyName(cp.name, param.first);
+            cp.value = param.second;
+            std::memcpy(p, &cp, sizeof(cp));
+            p += sizeof(cp);
+        }
+        for (size_t c = 0; c < run.columns.size(); c++) {
+            CatalogColumn col;
+            catalog::copyName(col.name, run.columns[c].first);
+            col.offset = head + c * cycles * sizeof(double);
+            std::memcpy(p, &col, sizeof(col));
+            p += sizeof(col);
+        }
+        std::memcpy(p, run.label.data(), run.label.size());
+        for (size_t c = 0; c < run.columns.size(); c++) {
+            const std::vector<double> &values = run.columns[c].second;
+            size_t n = std::min(values.size(), cycles);
+            std::memcpy(record.data() + head + c * cycles * sizeof(double), values.data(), n * sizeof(double));
+        }
+
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0)
+            return false;
+        bool ok = (::flock(fd, LOCK_EX) == 0);
+        struct stat st;
+        if (ok && ::fstat(fd, &st) == 0 && st.st_size == 0) {
+            CatalogFileHeader fh;
+            std::memcpy(fh.magic, "FVCATLG1", 8);
+            fh.version = 1;
+            fh.reserved = 0;
+            ok = ::write(fd, &fh, sizeof(fh)) == static_cast<ssize_t>(sizeof(fh));
+        }
+        size_t written = 0;
+        while (ok && written < record.size()) {
+            ssize_t w = ::write(fd, record.data() + written, record.size() - written);
+            if (w <= 0)
+                ok = false;
+            else
+                written += static_cast<size_t>(w);
+        }
+        ::flock(fd, LOCK_UN);
+        ::close(fd);
+        return ok;
+    }
+};
+
+// Read-only memory-mapped view of a catalog.
+class CatalogView {
+public:
+    // One run of the catalog, pointing into the mapping.
+    struct Run {
+        const CatalogRunHeader *header;
+        const CatalogParameter *parameters;
+        const CatalogColumn *columns;
+        const char *label;
+
+        std::string getLabel() const { return std::string(label, header->labelBytes); }
+
+        // Parameter value, or `fallback` if the run does not have it.
+        double parameter(const std::string &name, double fallback = 0.0) const {
+            for (uint32_t i = 0; i < header->parameters; i++)
+                if (name == parameters[i].name)
+                    return parameters[i].value;
+            return fallback;
+        }
+        bool hasParameter(const std::string &name) const {
+            for (uint32_t i = 0; i < header->parameters; i++)
+                if (name == parameters[i].name)
+                    return true;
+            return false;
+        }
+
+        // Metric block of a column (header->cycles values), or nullptr.
+        const double *column(const std::string &name) const {
+            const char *base = reinterpret_cast<const char *>(header);
+            for (uint32_t i = 0; i < header->columns; i++)
+                if (name == columns[i].name)
+                    return reinterpret_cast<const double *>(base + columns[i].offset);
+            return nullptr;
+        }
+    };
+
+private:
+    int fd;
+    const char *data;
+    size_t size;
+    std::vector<Run> runs;
+
+public:
+    explicit CatalogView(const std::string &path) : fd(-1), data(nullptr), size(0) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CatalogFileHeader)))
+            return;
+        size = static_cast<size_t>(st.st_size);
+        void *m = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (m == MAP_FAILED) {
+            size = 0;
+            return;
+        }
+        data = static_cast<const char *>(m);
+        if (std::memcmp(data, "FVCATLG1", 8) != 0)
+            return;
+        // Walk the record headers; a truncated last record (run still appending) is skipped.
+        size_t off = sizeof(CatalogFileHeader);
+        while (off + sizeof(CatalogRunHeader) <= size) {
+            const auto *h = reinterpret_cast<const CatalogRunHeader *>(data + off);
+            if (std::memcmp(h->magic, "FVRUNREC", 8) != 0 || h->recordBytes == 0 || off + h->recordBytes > size)
+                break;
+            Run r;
+            r.header = h;
+            r.parameters = reinterpret_cast<const CatalogParameter *>(h + 1);
+            r.columns = reinterpret_cast<const CatalogColumn *>(r.parameters + h->parameters);
+            r.label = reinterpret_cast<const char *>(r.columns + h->columns);
+            runs.push_back(r);
+            off += h->recordBytes;
+        }
+    }
+
+    ~CatalogView() {
+        if (data)
+            ::munmap(const_cast<char *>(data), size);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    CatalogView(const CatalogView &) = delete;
+    CatalogView &operator=(const CatalogView &) = delete;
+
+    bool isOpen() const { return data != nullptr; }
+    const std::vector<Run> &getRuns() const { return runs; }
+};
+
+#endif // CATALOG_H
@@ -0,0 +1,181 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <sys/resource.h>
+
+// Memory accounting per subsystem.
+//
+// The containers that grow with the village allocate through TrackedAllocator, whose
+// tag names the subsystem charged; storage allocated outside them (the population
+// arena) reports itself through MemoryAccounting::allocated/released. Every tag keeps
+// its current bytes, the highest bytes since the last resetPeaks() and the number of
+// allocations, in relaxed atomics so the market and bootstrap threads can allocate.
+// The counters are process-wide: with several simulations in one process (calibrate,
+// compare), they hold the sum of all of them.
+
+enum class MemoryTag : int {
+    Fishers = 0,     // The fishermen and the World's list of them
+    Firms = 1,       // The firms and the World's list of them
+    Sales = 2,       // Each firm's sale records of the day
+    FishMarket = 3,  // Fish offerings, orders and the clearing's per-order results
+    JobMarket = 4,   // Job postings, applications and matches
+    History = 5,     // The simulation's daily metric series
+    Count = 6
+};
+
+constexpr int memoryTags = static_cast<int>(MemoryTag::Count);
+
+inline const char *memoryTagName(MemoryTag tag) {
+    static const char *names[memoryTags] = {"Fishers", "Firms", "Sales", "FishMarket", "JobMarket", "History"};
+    return names[static_cast<int>(tag)];
+}
+
+// Counters of one tag.
+struct MemoryCounter {
+    std::atomic<int64_t> bytes{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<uint64_t> allocations{0};
+};
+
+// A copy of one tag's counters.
+struct MemoryUsage {
+    int64_t bytes = 0;
+    int64_t peak = 0;
+    uint64_t allocations = 0;
+};
+
+class MemoryAccounting {
+public:
+    static MemoryCounter &counter(MemoryTag tag) {
+        static MemoryCounter counters[memoryTags];
+        return counters[static_cast<int>(tag)];
+    }
+
+    static void allocated(MemoryTag tag, size_t size) {
+        MemoryCounter &c = counter(tag);
+        int64_t now = c.bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed)
+                      + static_cast<int64_t>(size);
+        c.allocations.fetch_add(1, std::memory_order_relaxed);
+        int64_t peak = c.peak.load(std::memory_order_relaxed);
+        while (now > peak && !c.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+            ;
+    }
+
+    static void released(MemoryTag tag, size_t size) {
+        counter(tag).bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    }
+
+    static MemoryUsage usage(MemoryTag tag) {
+        const MemoryCounter &c = counter(tag);
+        MemoryUsage u;
+        u.bytes = c.bytes.load(std::memory_order_relaxed);
+        u.peak = c.peak.load(std::memory_order_relaxed);
+        u.allocations = c.allocations.load(std::memory_order_relaxed);
+        return u;
+    }
+
+    // Start a new peak window: every tag's peak drops to its current bytes.
+    static void resetPeaks() {
+        for (int t = 0; t < memoryTags; t++) {
+            MemoryCounter &c = counter(static_cast<MemoryTag>(t));
+            c.peak.store(c.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    static int64_t totalBytes() {
+        int64_t total = 0;
+        for (int t = 0; t < memoryTags; t++)
+            total += usage(static_cast<MemoryTag>(t)).bytes;
+        return total;
+    }
+
+    // Peak resident set size of the process so far, in bytes.
+    static int64_t peakResidentBytes() {
+        struct rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) != 0)
+            return 0;
+#ifdef __APPLE__
+        return static_cast<int64_t>(ru.ru_maxrss);         // Bytes on macOS
+#else
+        return static_cast<int64_t>(ru.ru_maxrss) * 1024;  // Kilobytes on Linux
+#endif
+    }
+};
+
+// std::allocator that charges its tag. Stateless, so containers of the same type
+// and tag can swap and move storage freely.
+template <class T, MemoryTag tag>
+struct TrackedAllocator {
+    using value_type = T;
+
+    template <class U>
+    struct rebind { using other = TrackedAllocator<U, tag>; };
+
+    TrackedAllocator() noexcept {}
+    template <class U>
+    TrackedAllocator(const TrackedAllocator<U, tag> &) noexcept {}
+
+    T *allocate(size_t n) {
+        T *p = static_cast<T*>(::operator new(n * sizeof(T)));
+        MemoryAccounting::allocated(tag, n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+        MemoryAccounting::released(tag, n * sizeof(T));
+        ::operator delete(p);
+    }
+};
+
+template <class T, class U, MemoryTag tag>
+bool operator==(const TrackedAllocator<T, tag> &, const TrackedAllocator<U, tag> &) { return true; }
+template <class T, class U, MemoryTag tag>
+bool operator!=(const TrackedAllocator<T, tag> &, const TrackedAllocator<U, tag> &) { return false; }
+
+template <class T, MemoryTag tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, tag>>;
+
+// A daily metric series of the simulation.
+template <class T>
+using MetricSeries = TrackedVector<T, MemoryTag::History>;
+
+// Per-cycle view of the counters: begin() opens a cycle window, and end() reports each
+// tag's bytes, its peak during the window and the allocations made in it.
+class MemoryCycle {
+private:
+    uint64_t startAllocations[memoryTags] = {};
+
+public:
+    void begin() {
+        MemoryAccounting::resetPeaks();
+        for (int t = 0; t < memoryTags; t++)
+            startAllocations[t] = MemoryAccounting::usage(static_cast<MemoryTag>(t)).allocations;
+    }
+
+    std::vector<MemoryUsage> end() const {
+        std::vector<MemoryUsage> out(memoryTags);
+        for (int t = 0; t < memoryTags; t++) {
+            out[t] = MemoryAccounting::usage(static_cast<MemoryTag>(t));
+            out[t].allocations -= startAllocations[t];
+        }
+        return out;
+    }
+
+    // CSV header fragment: <Tag>Bytes,<Tag>Peak,<Tag>Allocs for each tag, then the totals.
+    static std::string columns() {
+        std::string s;
+        for (int t = 0; t < memoryTags; t++) {
+            std::string name = memoryTagName(static_cast<MemoryTag>(t));
+            s += "," + name + "Bytes," + name + "Peak," + name + "Allocs";
+        }
+        return s + ",TrackedBytes,BytesPerAgent,PeakRSS";
+    }
+};
+
+#endif
@@ -0,0 +1,521 @@
+#ifndef PANEL_H
+#define PANEL_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Agent-level panel: snapshots of every fisherman's funds, employer, hunger and age,
+// taken every few cycles and stored compactly.
+//
+// File layout:
+//   PanelHeader
+//   chunk bytes ...            one or more chunks per snapshot
+//   PanelSnapshotEntry[]       one per snapshot
+//   PanelChunkEntry[]          one per chunk (snapshots' chunks are contiguous)
+//   PanelTrailer               where the two tables are, written last
+//
+// A snapshot is sorted by agent ID and cut into chunks of at most chunkAgents agents.
+// Within a chunk, each column is stored separately as zigzag varints:
+//   ids      first ID, then gaps to the previous ID
+//   funds    cents, minus the agent's value in the previous snapshot
+//   employer firm ID (-1 = unemployed), minus the previous value
+//   hunger   days without eating, minus the previous value
+//   age      days, minus (previous age + cycles elapsed)
+// Agents missing from the previous snapshot, and every agent in a keyframe snapshot,
+// are encoded against zero. So one agent at one cycle is recovered by decoding a
+// single chunk per snapshot since the last keyframe; the chunk is found by binary
+// search on the chunk table.
+
+struct PanelHeader {
+    char magic[8];          // "FVPANEL1"
+    uint32_t version;
+    uint32_t interval;      // Cycles between snapshots
+    uint32_t keyframe;      // Snapshots between keyframes
+    uint32_t chunkAgents;   // Agents per chunk
+};
+
+struct PanelSnapshotEntry {
+    int32_t cycle;
+    uint32_t agents;
+    uint32_t firstChunk;    // Index of its first chunk in the chunk table
+    uint32_t chunks;
+    uint32_t keyframe;      // 1 if encoded without reference to the previous snapshot
+    uint32_t reserved;
+};
+
+struct PanelChunkEntry {
+    int32_t firstID;
+    int32_t lastID;
+    uint64_t offset;        // File offset of the chunk bytes
+    uint32_t bytes;
+    uint32_t agents;
+};
+
+struct PanelTrailer {
+    uint64_t snapshots;
+    uint64_t snapshotTable;
+    uint64_t chunks;
+    uint64_t chunkTable;
+    char magic[8];          // "FVPINDEX"
+};
+
+// One agent in one snapshot.
+struct PanelRecord {
+    int cycle;
+    int id;
+    double funds;
+    int employer;           // Firm ID, -1 if unemployed
+    int daysWithoutEat;
+    int age;
+};
+
+// Columns of one snapshot, captured on the simulation thread.
+struct PanelSnapshot {
+    int cycle = 0;
+    std::vector<int32_t> ids;
+    std::vector<int64_t> funds;       // Cents
+    std::vector<int32_t> employer;
+    std::vector<int32_t> hunger;
+    std::vector<int32_t> age;
+
+    void add(int id, double fundsValue, int employerID, int daysWithoutEat, int ageDays) {
+        ids.push_back(id);
+        funds.push_back(std::llround(fundsValue * 100.0));
+        employer.push_back(employerID);
+        hunger.push_back(daysWithoutEat);
+        age.push_back(ageDays);
+    }
+    size_t size() const { return ids.size(); }
+};
+
+namespace panel {
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+inline int64_t unzigzag(uint64_t u) {
+    return static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+}
+
+inline void putVarint(std::vector<uint8_t> &out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+inline uint64_t getVarint(const uint8_t *&p, const uint8_t *end) {
+    uint64_t v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+    return v;
+}
+
+} // namespace panel
+
+class PanelWriter {
+private:
+    std::ofstream file;
+    PanelHeader header;
+    std::vector<PanelSnapshotEntry> snapshotTable;
+    std::vector<PanelChunkEntry> chunkTable;
+    uint64_t offset;
+
+    // Previous snapshot (sorted by ID), the reference of the deltas.
+    PanelSnapshot previous;
+
+    // Background encoder: the simulation thread only captures columns.
+    std::deque<PanelSnapshot> queue;
+    std::mutex mutex;
+    std::condition_variable ready, space;
+    bool closing;
+    size_t pending;          // Snapshots captured but not yet written
+    size_t maxQueued;
+    std::thread worker;
+
+    void work() {
+        for (;;) {
+            PanelSnapshot snap;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return closing || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                snap = std::move(queue.front());
+                queue.pop_front();
+            }
+            encode(snap);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending--;
+            }
+            space.notify_all();
+        }
+    }
+
+    void encode(PanelSnapshot &snap) {
+        // Snapshots are usually already in ID order; sort only if they are not.
+        if (!std::is_sorted(snap.ids.begin(), snap.ids.end())) {
+            std::vector<size_t> order(snap.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(),
+                      [&snap](size_t a, size_t b) { return snap.ids[a] < snap.ids[b]; });
+            PanelSnapshot sorted;
+            sorted.cycle = snap.cycle;
+            for (size_t i : order) {
+                sorted.ids.push_back(snap.ids[i]);
+                sorted.funds.push_back(snap.funds[i]);
+                sorted.employer.push_back(snap.employer[i]);
+                sorted.hunger.push_back(snap.hunger[i]);
+                sorted.age.push_back(snap.age[i]);
+            }
+            snap = std::move(sorted);
+        }
+
+        PanelSnapshotEntry entry;
+        entry.cycle = snap.cycle;
+        entry.agents = static_cast<uint32_t>(snap.size());
+        entry.firstChunk = static_cast<uint32_t>(chunkTable.size());
+        entry.chunks = 0;
+        entry.keyframe = (snapshotTable.size() % header.keyframe == 0) ? 1 : 0;
+        entry.reserved = 0;
+        int elapsed = previous.ids.empty() ? 0 : snap.cycle - previous.cycle;
+
+        // Reference row of each agent in the previous snapshot (merge join on ID).
+        std::vector<int64_t> ref(snap.size(), -1);
+        if (!entry.keyframe) {
+            size_t j = 0;
+            for (size_t i = 0; i < snap.size(); i++) {
+                while (j < previous.ids.size() && previous.ids[j] < snap.ids[i])
+                    j++;
+                if (j < previous.ids.size() && previous.ids[j] == snap.ids[i])
+                    ref[i] = static_cast<int64_t>(j);
+            }
+        }
+
+        std::vector<uint8_t> bytes;
+        for (size_t begin = 0; begin < snap.size(); begin += header.chunkAgents) {
+            size_t end = std::min(snap.size(), begin + header.chunkAgents);
+            bytes.clear();
+            panel::putVarint(bytes, end - begin);
+            panel::putVarint(bytes, panel::zigzag(snap.ids[begin]));
+            for (size_t i = begin + 1; i < end; i++)
+                panel::putVarint(bytes, static_cast<uint64_t>(snap.ids[i] - snap.ids[i - 1]));
+            for (size_t i = begin; i < end; i++)
+                panel::putVarint(bytes, panel::zigzag(snap.funds[i] - (ref[i] >= 0 ? previous.funds[ref[i]] : 0)));
+            for (size_t i = begin; i < end; i++)
+                panel::putVarint(bytes, panel::zigzag(snap.employer[i] - (ref[i] >= 0 ? previous.employer[ref[i]] : 0)));
+            for (size_t i = begin; i < end; i++)
+                panel::putVarint(bytes, panel::zigzag(snap.hunger[i] - (ref[i] >= 0 ? previous.hunger[ref[i]] : 0)));
+            for (size_t i = begin; i < end; i++)
+                panel::putVarint(bytes, panel::zigzag(snap.age[i] - (ref[i] >= 0 ? previous.age[ref[i]] + elapsed : 0)));
+
+            PanelChunkEntry chunk;
+            chunk.firstID = snap.ids[begin];
+            chunk.lastID = snap.ids[end - 1];
+            chunk.offset = offset;
+            chunk.bytes = static_cast<uint32_t>(bytes.size());
+            chunk.agents = static_cast<uint32_t>(end - begin);
+            file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            offset += bytes.size();
+            chunkTable.push_back(chunk);
+            entry.chunks++;
+        }
+        snapshotTable.push_back(entry);
+        previous = std::move(snap);
+    }
+
+public:
+    // Open a panel file. Snapshots are expected every `interval` cycles; every
+    // `keyframe`-th snapshot is self-contained. At most `queued` captured snapshots
+    // wait for the encoder before capture() blocks.
+    PanelWriter(const std::string &path, int interval, int keyframe = 16,
+                int chunkAgents = 4096, size_t queued = 2)
+        : file(path, std::ios::binary | std::ios::trunc), offset(0),
+          closing(false), pending(0), maxQueued(std::max<size_t>(queued, 1))
+    {
+        std::memcpy(header.magic, "FVPANEL1", 8);
+        header.version = 1;
+        header.interval = static_cast<uint32_t>(std::max(interval, 1));
+        header.keyframe = static_cast<uint32_t>(std::max(keyframe, 1));
+        header.chunkAgents = static_cast<uint32_t>(std::max(chunkAgents, 1));
+        if (file.is_open()) {
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            offset = sizeof(header);
+            worker = std::thread(&PanelWriter::work, this);
+        }
+    }
+
+    ~PanelWriter() { close(); }
+
+    PanelWriter(const PanelWriter &) = delete;
+    PanelWriter &operator=(const PanelWriter &) = delete;
+
+    bool isOpen() const { return file.is_open(); }
+
+    // Hand a captured snapshot to the encoder thread.
+    void capture(PanelSnapshot &&snap) {
+        if (!file.is_open())
+            return;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            space.wait(lock, [this] { return queue.size() < maxQueued; });
+            queue.push_back(std::move(snap));
+            pending++;
+        }
+        ready.notify_one();
+    }
+
+    // Wait until every captured snapshot has been written (e.g. before fork()).
+    void flush() {
+        if (!file.is_open())
+            return;
+        std::unique_lock<std::mutex> lock(mutex);
+        space.wait(lock, [this] { return pending == 0; });
+        file.flush();
+    }
+
+    // Write every captured snapshot and stop the encoder thread, so that the process
+    // can fork(); resume() starts it again.
+    void suspend() {
+        if (!file.is_open() || !worker.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closing = true;
+        }
+        ready.notify_one();
+        worker.join();
+        closing = false;
+        file.flush();
+    }
+
+    void resume() {
+        if (file.is_open() && !worker.joinable())
+            worker = std::thread(&PanelWriter::work, this);
+    }
+
+    // Close without writing the index (e.g. a forked child leaving its parent's file).
+    // The writer must be suspended.
+    void detach() {
+        if (file.is_open())
+            file.close();
+    }
+
+    // Drain the queue, then write the index and the trailer.
+    void close() {
+        if (!file.is_open())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closing = true;
+        }
+        ready.notify_one();
+        if (worker.joinable())
+            worker.join();
+
+        PanelTrailer trailer;
+        trailer.snapshots = snapshotTable.size();
+        trailer.snapshotTable = offset;
+        file.write(reinterpret_cast<const char *>(snapshotTable.data()),
+                   static_cast<std::streamsize>(snapshotTable.size() * sizeof(PanelSnapshotEntry)));
+        offset += snapshotTable.size() * sizeof(PanelSnapshotEntry);
+        trailer.chunks = chunkTable.size();
+        trailer.chunkTable = offset;
+        file.write(reinterpret_cast<const char *>(chunkTable.data()),
+                   static_cast<std::streamsize>(chunkTable.size() * sizeof(PanelChunkEntry)));
+        std::memcpy(trailer.magic, "FVPINDEX", 8);
+        file.write(reinterpret_cast<const char *>(&trailer), sizeof(trailer));
+        file.close();
+    }
+};
+
+class PanelReader {
+private:
+    std::ifstream file;
+    PanelHeader header;
+    std::vector<PanelSnapshotEntry> snapshotTable;
+    std::vector<PanelChunkEntry> chunkTable;
+    bool valid;
+
+    // Decoded deltas of one chunk (ids absolute, other columns as stored).
+    struct Chunk {
+        std::vector<int32_t> ids;
+        std::vector<int64_t> funds, employer, hunger, age;
+    };
+
+    bool readChunk(const PanelChunkEntry &entry, Chunk &c) {
+        std::vector<uint8_t> bytes(entry.bytes);
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(entry.offset));
+        file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file)
+            return false;
+        const uint8_t *p = bytes.data();
+        const uint8_t *end = p + bytes.size();
+        size_t n = static_cast<size_t>(panel::getVarint(p, end));
+        c.ids.resize(n);
+        if (n == 0)
+            return true;
+        c.ids[0] = static_cast<int32_t>(panel::unzigzag(panel::getVarint(p, end)));
+        for (size_t i = 1; i < n; i++)
+            c.ids[i] = c.ids[i - 1] + static_cast<int32_t>(panel::getVarint(p, end));
+        for (auto *column : {&c.funds, &c.employer, &c.hunger, &c.age}) {
+            column->resize(n);
+            for (size_t i = 0; i < n; i++)
+                (*column)[i] = panel::unzigzag(panel::getVarint(p, end));
+        }
+        return true;
+    }
+
+    // Chunk of a snapshot that may hold an agent, or -1.
+    long findChunk(const PanelSnapshotEntry &snap, int id) const {
+        auto first = chunkTable.begin() + snap.firstChunk;
+        auto last = first + snap.chunks;
+        auto it = std::lower_bound(first, last, id,
+            [](const PanelChunkEntry &c, int value) { return c.lastID < value; });
+        if (it == last || it->firstID > id)
+            return -1;
+        return static_cast<long>(it - chunkTable.begin());
+    }
+
+public:
+    explicit PanelReader(const std::string &path)
+        : file(path, std::ios::binary), valid(false)
+    {
+        if (!file.is_open())
+            return;
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (!file || std::memcmp(header.magic, "FVPANEL1", 8) != 0)
+            return;
+        PanelTrailer trailer;
+        file.seekg(-static_cast<std::streamoff>(sizeof(trailer)), std::ios::end);
+        file.read(reinterpret_cast<char *>(&trailer), sizeof(trailer));
+        if (!file || std::memcmp(trailer.magic, "FVPINDEX", 8) != 0)
+            return;
+        snapshotTable.resize(trailer.snapshots);
+        file.seekg(static_cast<std::streamoff>(trailer.snapshotTable));
+        file.read(reinterpret_cast<char *>(snapshotTable.data()),
+                  static_cast<std::streamsize>(snapshotTable.size() * sizeof(PanelSnapshotEntry)));
+        chunkTable.resize(trailer.chunks);
+        file.seekg(static_cast<std::streamoff>(trailer.chunkTable));
+        file.read(reinterpret_cast<char *>(chunkTable.data()),
+                  static_cast<std::streamsize>(chunkTable.size() * sizeof(PanelChunkEntry)));
+        valid = static_cast<bool>(file);
+    }
+
+    bool isValid() const { return valid; }
+    int getInterval() const { return static_cast<int>(header.interval); }
+
+    // Cycles of the stored snapshots.
+    std::vector<int> cycles() const {
+        std::vector<int> out;
+        for (const auto &s : snapshotTable)
+            out.push_back(s.cycle);
+        return out;
+    }
+
+    // One agent's records, one per snapshot where he is present. Only the chunk that
+    // holds him is read in each snapshot.
+    std::vector<PanelRecord> trajectory(int id) { return trajectory(id, 0, snapshotTable.size()); }
+
+    // The agent's records for the snapshots [from, to) of the table. Decoding starts
+    // at the keyframe preceding `from`.
+    std::vector<PanelRecord> trajectory(int id, size_t from, size_t to) {
+        std::vector<PanelRecord> out;
+        to = std::min(to, snapshotTable.size());
+        if (!valid || from >= to)
+            return out;
+        size_t s = from;
+        while (s > 0 && !snapshotTable[s].keyframe)
+            s--;
+        bool known = false;
+        PanelRecord last{};
+        Chunk c;
+        for (; s < to; s++) {
+            const PanelSnapshotEntry &snap = snapshotTable[s];
+            long chunk = findChunk(snap, id);
+            size_t row = 0;
+            bool present = false;
+            if (chunk >= 0 && readChunk(chunkTable[chunk], c)) {
+                auto it = std::lower_bound(c.ids.begin(), c.ids.end(), id);
+                present = (it != c.ids.end() && *it == id);
+                row = static_cast<size_t>(it - c.ids.begin());
+            }
+            if (!present) {
+                known = false;
+                continue;
+            }
+            bool delta = known && !snap.keyframe;
+            int elapsed = delta ? snap.cycle - last.cycle : 0;
+            int64_t funds = c.funds[row] + (delta ? std::llround(last.funds * 100.0) : 0);
+            PanelRecord r;
+            r.cycle = snap.cycle;
+            r.id = id;
+            r.funds = static_cast<double>(funds) / 100.0;
+            r.employer = static_cast<int>(c.employer[row] + (delta ? last.employer : 0));
+            r.daysWithoutEat = static_cast<int>(c.hunger[row] + (delta ? last.daysWithoutEat : 0));
+            r.age = static_cast<int>(c.age[row] + (delta ? last.age + elapsed : 0));
+            last = r;
+            known = true;
+            if (s >= from)
+                out.push_back(r);
+        }
+        return out;
+    }
+
+    // Every agent of one snapshot, decoded forward from the preceding keyframe.
+    std::vector<PanelRecord> snapshot(size_t index) {
+        std::vector<PanelRecord> current;
+        if (!valid || index >= snapshotTable.size())
+            return current;
+        size_t s = index;
+        while (s > 0 && !snapshotTable[s].keyframe)
+            s--;
+        std::vector<PanelRecord> previous;
+        Chunk c;
+        for (; s <= index; s++) {
+            const PanelSnapshotEntry &snap = snapshotTable[s];
+            current.clear();
+            size_t j = 0;
+            for (uint32_t k = 0; k < snap.chunks; k++) {
+                if (!readChunk(chunkTable[snap.firstChunk + k], c))
+                    return {};
+                for (size_t i = 0; i < c.ids.size(); i++) {
+                    while (!snap.keyframe && j < previous.size() && previous[j].id < c.ids[i])
+                        j++;
+                    bool delta = !snap.keyframe && j < previous.size() && previous[j].id == c.ids[i];
+                    const PanelRecord *ref = delta ? &previous[j] : nullptr;
+                    PanelRecord r;
+                    r.cycle = snap.cycle;
+                    r.id = c.ids[i];
+                    int64_t funds = c.funds[i] + (ref ? std::llround(ref->funds * 100.0) : 0);
+                    r.funds = static_cast<double>(funds) / 100.0;
+                    r.employer = static_cast<int>(c.employer[i] + (ref ? ref->employer : 0));
+                    r.daysWithoutEat = static_cast<int>(c.hunger[i] + (ref ? ref->daysWithoutEat : 0));
+                    r.age = static_cast<int>(c.age[i] + (ref ? ref->age + (snap.cycle - ref->cycle) : 0));
+                    current.push_back(r);
+                }
+            }
+            previous.swap(current);
+        }
+        return previous;
+    }
+};
+
+#endif // PANEL_H
@@ -0,0 +1,373 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Multi-resolution metric pyramid, built while the run is in progress.
+//
+// Level k holds one bucket per 2^k cycles. Each bucket stores, for every series, the
+// min, max, mean and last value, plus a representative point chosen in the style of
+// LTTB (largest triangle three buckets). The representative is one of its two
+// children's representatives: the one forming the largest triangle with the previous
+// bucket's representative and the next bucket's mean. Spikes and crashes that
+// striding would skip therefore stay visible at every zoom level. Each cycle costs
+// amortised O(1) work.
+//
+// The file is laid out up front for totalCycles cycles:
+//   PyramidHeader
+//   char[32] per series          series names
+//   PyramidLevel[levels]         offset, capacity and number of written buckets
+//   buckets of level 0, level 1, ...  (series PyramidCells per bucket)
+// Buckets are written in place with pwrite() and the written counts updated as
+// they complete. A viewer can therefore map the file during the run and read the
+// buckets of any level directly, in O(points on screen).
+
+struct PyramidHeader {
+    char magic[8];          // "FVPYRMD1"
+    uint32_t version;
+    uint32_t series;
+    uint32_t levels;
+    uint32_t reserved;
+    uint64_t capacity;      // Cycles the file was laid out for
+};
+
+struct PyramidLevel {
+    uint64_t offset;        // File offset of the first bucket
+    uint64_t buckets;       // Capacity in buckets
+    uint64_t written;       // Buckets written so far
+};
+
+struct PyramidCell {
+    double min;
+    double max;
+    double mean;
+    double last;
+    double pickCycle;       // Representative point (LTTB style)
+    double pickValue;
+};
+
+class PyramidWriter {
+private:
+    // A bucket being filled from its children.
+    struct Accumulator {
+        std::vector<double> min, max, sum, last;
+        std::vector<PyramidCell> picks;   // Candidate representatives: one per child and series
+        uint64_t count = 0;               // Cycles covered
+        uint64_t first = 0;               // First cycle (0-based)
+        int children = 0;
+    };
+    // A completed bucket whose representative waits for the next bucket's mean.
+    struct Waiting {
+        bool valid = false;
+        uint64_t index = 0;
+        uint64_t first = 0, count = 0;
+        std::vector<PyramidCell> cells;       // min/max/mean/last filled in
+        std::vector<PyramidCell> candidates;  // picks of the children, child-major
+        int children = 0;
+    };
+
+    int fd;
+    size_t series;
+    std::vector<PyramidLevel> table;
+    uint64_t tableOffset;
+    std::vector<Accumulator> accumulators;  // Per level, fed by the level below
+    std::vector<Waiting> waiting;           // Per level
+    std::vector<std::vector<PyramidCell>> previousPick;  // Per level, last decided representatives
+    std::vector<bool> hasPrevious;
+    uint64_t cycles;
+
+    void resetAccumulator(Accumulator &a) {
+        a.min.assign(series, std::numeric_limits<double>::infinity());
+        a.max.assign(series, -std::numeric_limits<double>::infinity());
+        a.sum.assign(series, 0.0);
+        a.last.assign(series, 0.0);
+        a.picks.clear();
+        a.count = 0;
+        a.children = 0;
+    }
+
+    // Decide the representative of the waiting bucket at a level, write it, and feed it
+    // to the level above. `next` is the following bucket (nullptr at the end of the run).
+    void release(size_t level, const Waiting *next) {
+        Waiting &w = waiting[level];
+        if (!w.valid)
+            return;
+        for (size_t s = 0; s < series; s++) {
+            if (w.children == 0)
+                continue;
+            double ax = 0.0, ay = 0.0, cx, cy;
+            const PyramidCell *best = &w.candidates[s];  // Kept if every area is NaN
+            if (next) {
+                cx = static_cast<double>(next->first) + 0.5 * static_cast<double>(next->count);
+                cy = next->cells[s].mean;
+            } else {
+                cx = static_cast<double>(w.first) + 0.5 * static_cast<double>(w.count);
+                cy = w.cells[s].mean;
+            }
+            if (hasPrevious[level]) {
+                ax = previousPick[level][s].pickCycle;
+                ay = previousPick[level][s].pickValue;
+            }
+            double bestArea = -1.0;
+            for (int c = 0; c < w.children; c++) {
+                const PyramidCell &cand = w.candidates[static_cast<size_t>(c) * series + s];
+                double area = hasPrevious[level]
+                    ? std::fabs((ax - cx) * (cand.pickValue - ay) - (ax - cand.pickCycle) * (cy - ay))
+                    : std::fabs(cand.pickValue - cy);
+                if (area > bestArea) {
+                    bestArea = area;
+                    best = &cand;
+                }
+            }
+            w.cells[s].pickCycle = best->pickCycle;
+            w.cells[s].pickValue = best->pickValue;
+        }
+        previousPick[level] = w.cells;
+        hasPrevious[level] = true;
+
+        PyramidLevel &L = table[level];
+        if (w.index < L.buckets) {
+            off_t at = static_cast<off_t>(L.offset + w.index * series * sizeof(PyramidCell));
+            ssize_t bytes = static_cast<ssize_t>(series * sizeof(PyramidCell));
+            if (::pwrite(fd, w.cells.data(), static_cast<size_t>(bytes), at) == bytes) {
+                L.written = w.index + 1;
+                ::pwrite(fd, &L.written, sizeof(L.written),
+                         static_cast<off_t>(tableOffset + level * sizeof(PyramidLevel) + offsetof(PyramidLevel, written)));
+            }
+        }
+        if (level + 1 < table.size())
+            feed(level + 1, w);
+        w.valid = false;
+    }
+
+    // Add a finished child bucket to the accumulator of `level`.
+    void feed(size_t level, const Waiting &child) {
+        Accumulator &a = accumulators[level];
+        if (a.children == 0)
+            a.first = child.first;
+        for (size_t s = 0; s < series; s++) {
+            a.min[s] = std::min(a.min[s], child.cells[s].min);
+            a.max[s] = std::max(a.max[s], child.cells[s].max);
+            a.sum[s] += child.cells[s].mean * static_cast<double>(child.count);
+            a.last[s] = child.cells[s].last;
+        }
+        a.picks.insert(a.picks.end(), child.cells.begin(), child.cells.end());
+        a.count += child.count;
+        a.children++;
+        if (a.children == 2)
+            complete(level);
+    }
+
+    // Turn the accumulator of `level` into a completed bucket.
+    void complete(size_t level) {
+        Accumulator &a = accumulators[level];
+        Waiting next;
+        next.valid = true;
+        next.first = a.first;
+        next.count = a.count;
+        next.index = a.first >> level;
+        next.children = a.children;
+        next.cells.resize(series);
+        for (size_t s = 0; s < series; s++) {
+            PyramidCell &c = next.cells[s];
+            c.min = a.min[s];
+            c.max = a.max[s];
+            c.mean = a.sum[s] / static_cast<double>(a.count);
+            c.last = a.last[s];
+            c.pickCycle = 0.0;
+            c.pickValue = 0.0;
+        }
+        next.candidates = a.picks;
+        resetAccumulator(a);
+        release(level, &next);
+        waiting[level] = std::move(next);
+    }
+
+public:
+    PyramidWriter(const std::string &path, const std::vector<std::string> &names, uint64_t capacity)
+        : fd(-1), series(names.size()), tableOffset(0), cycles(0)
+    {
+        capacity = std::max<uint64_t>(capacity, 1);
+        size_t levels = 1;
+        while ((uint64_t(1) << (levels - 1)) < capacity)
+            levels++;
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return;
+
+        PyramidHeader h;
+        std::memcpy(h.magic, "FVPYRMD1", 8);
+        h.version = 1;
+        h.series = static_cast<uint32_t>(series);
+        h.levels = static_cast<uint32_t>(levels);
+        h.reserved = 0;
+        h.capacity = capacity;
+        std::vector<char> head(sizeof(h) + series * 32, 0);
+        std::memcpy(head.data(), &h, sizeof(h));
+        for (size_t s = 0; s < series; s++)
+            std::memcpy(head.data() + sizeof(h) + s * 32, names[s].data(), std::min<size_t>(names[s].size(), 31));
+        tableOffset = head.size();
+
+        uint64_t offset = tableOffset + levels * sizeof(PyramidLevel);
+        table.resize(levels);
+        for (size_t k = 0; k < levels; k++) {
+            table[k].offset = offset;
+            table[k].buckets = (capacity + (uint64_t(1) << k) - 1) >> k;
+            table[k].written = 0;
+            offset += table[k].buckets * series * sizeof(PyramidCell);
+        }
+        bool ok = ::write(fd, head.data(), head.size()) == static_cast<ssize_t>(head.size())
+               && ::write(fd, table.data(), table.size() * sizeof(PyramidLevel))
+                  == static_cast<ssize_t>(table.size() * sizeof(PyramidLevel))
+               && ::ftruncate(fd, static_cast<off_t>(offset)) == 0;
+        if (!ok) {
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+        accumulators.resize(levels);
+        for (auto &a : accumulators)
+            resetAccumulator(a);
+        waiting.resize(levels);
+        previousPick.resize(levels);
+        hasPrevious.assign(levels, false);
+    }
+
+    ~PyramidWriter() { close(); }
+
+    PyramidWriter(const PyramidWriter &) = delete;
+    PyramidWriter &operator=(const PyramidWriter &) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Append one cycle (one value per series).
+    void append(const std::vector<double> &values) {
+        if (fd < 0 || values.size() != series)
+            return;
+        Waiting point;
+        point.valid = true;
+        point.first = cycles;
+        point.count = 1;
+        point.index = cycles;
+        point.children = 1;
+        point.cells.resize(series);
+        for (size_t s = 0; s < series; s++) {
+            double v = values[s];
+            point.cells[s] = {v, v, v, v, static_cast<double>(cycles), v};
+        }
+        point.candidates = point.cells;
+        release(0, &point);
+        waiting[0] = std::move(point);
+        cycles++;
+    }
+
+    // Close without writing the pending buckets (e.g. a forked child leaving its
+    // parent's file).
+    void detach() {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+
+    // Write the pending buckets of every level (partial buckets included).
+    void close() {
+        if (fd < 0)
+            return;
+        for (size_t k = 0; k < table.size(); k++) {
+            release(k, nullptr);
+            if (k + 1 < table.size() && accumulators[k + 1].children > 0)
+                complete(k + 1);
+        }
+        ::close(fd);
+        fd = -1;
+    }
+};
+
+// Read-only view of a pyramid file, usable while the run is still writing it.
+class PyramidReader {
+private:
+    int fd;
+    const char *data;
+    size_t size;
+    const PyramidHeader *header;
+    std::vector<std::string> names;
+    const PyramidLevel *table;
+
+public:
+    explicit PyramidReader(const std::string &path)
+        : fd(-1), data(nullptr), size(0), header(nullptr), table(nullptr)
+    {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PyramidHeader)))
+            return;
+        size = static_cast<size_t>(st.st_size);
+        void *m = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (m == MAP_FAILED)
+            return;
+        data = static_cast<const char *>(m);
+        header = reinterpret_cast<const PyramidHeader *>(data);
+        if (std::memcmp(header->magic, "FVPYRMD1", 8) != 0) {
+            header = nullptr;
+            return;
+        }
+        for (uint32_t s = 0; s < header->series; s++)
+            names.push_back(std::string(data + sizeof(PyramidHeader) + s * 32));
+        table = reinterpret_cast<const PyramidLevel *>(data + sizeof(PyramidHeader) + header->series * 32);
+    }
+
+    ~PyramidReader() {
+        if (data)
+            ::munmap(const_cast<char *>(data), size);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    PyramidReader(const PyramidReader &) = delete;
+    PyramidReader &operator=(const PyramidReader &) = delete;
+
+    bool isOpen() const { return header != nullptr; }
+    const std::vector<std::string> &getSeries() const { return names; }
+    size_t getLevels() const { return header ? header->levels : 0; }
+
+    // Coarsest-enough level: the finest one showing [first, last) in at most `points` buckets.
+    size_t levelFor(uint64_t first, uint64_t last, size_t points) const {
+        uint64_t span = last > first ? last - first : 1;
+        size_t k = 0;
+        while (k + 1 < getLevels() && (span >> k) > points)
+            k++;
+        return k;
+    }
+
+    // Buckets of one series covering cycles [first, last) (0-based), at most about
+    // `points` of them; only written buckets are returned.
+    std::vector<PyramidCell> fetch(size_t seriesIndex, uint64_t first, uint64_t last, size_t points) const {
+        std::vector<PyramidCell> out;
+        if (!header || seriesIndex >= header->series)
+            return out;
+        size_t k = levelFor(first, last, std::max<size_t>(points, 1));
+        const PyramidLevel &L = table[k];
+        uint64_t b0 = first >> k;
+        uint64_t b1 = std::min<uint64_t>(((last + (uint64_t(1) << k) - 1) >> k), L.written);
+        for (uint64_t b = b0; b < b1; b++) {
+            const auto *cells = reinterpret_cast<const PyramidCell *>(data + L.offset + b * header->series * sizeof(PyramidCell));
+            out.push_back(cells[seriesIndex]);
+        }
+        return out;
+    }
+};
+
+#endif // PYRAMID_H
@@ -0,0 +1,235 @@
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// Streaming quantile sketch in the style of KLL (Karnin, Lang, Liberty).
+//
+// Items live in a stack of compactors; an item at level h stands for 2^h inputs.
+// When a level is full it is sorted and every other item (random offset) moves up
+// one level, so memory stays O(k) whatever the stream length and rank queries are
+// off by roughly n / k. Sketches built on different threads or partitions can be
+// merged. Queries sort only the few retained items (cached until the next insert),
+// never the stream.
+class QuantileSketch {
+private:
+    size_t k;                                  // Accuracy: capacity of the top level
+    std::vector<std::vector<double>> levels;   // levels[h]: items of weight 2^h
+    size_t held;                               // Items currently retained over all levels
+    size_t limit;                              // Sum of the level capacities
+    uint64_t n;                                // Total weight inserted
+    double sum;                                // Exact sum of the inserted values
+    double minValue, maxValue;
+    uint64_t coin;                             // Private xorshift state for compaction offsets
+
+    mutable bool dirty;
+    mutable std::vector<std::pair<double, double>> sorted;  // (value, weight), ascending
+    mutable double sortedWeight, sortedSum;
+
+    size_t capacity(size_t h) const {
+        size_t depth = levels.size() - 1 - h;
+        double cap = std::ceil(static_cast<double>(k) * std::pow(2.0 / 3.0, static_cast<double>(depth)));
+        return std::max<size_t>(2, static_cast<size_t>(cap));
+    }
+
+    bool flip() {
+        coin ^= coin << 13;
+        coin ^= coin >> 7;
+        coin ^= coin << 17;
+        return (coin & 1) != 0;
+    }
+
+    void ensureLevel(size_t h) {
+        if (levels.size() > h)
+            return;
+        while (levels.size() <= h)
+            levels.emplace_back();
+        limit = 0;
+        for (size_t l = 0; l < levels.size(); l++)
+            limit += capacity(l);
+    }
+
+    // While the sketch holds more than its total capacity, compact the lowest full
+    // level. Compaction is therefore amortised over many inserts.
+    void compress() {
+        while (held >= limit) {
+            size_t h = 0;
+            while (h + 1 < levels.size() && levels[h].size() < capacity(h))
+                h++;
+            ensureLevel(h + 1);
+            std::vector<double> &level = levels[h];
+            std::sort(level.begin(), level.end());
+            // An odd item out stays at this level, so total weight is conserved.
+            double last = 0.0;
+            bool odd = (level.size() % 2) != 0;
+            if (odd) {
+                last = level.back();
+                level.pop_back();
+            }
+            size_t before = level.size();
+            for (size_t i = flip() ? 1 : 0; i < level.size(); i += 2)
+                levels[h + 1].push_back(level[i]);
+            level.clear();
+            held -= before / 2;
+            if (odd)
+                level.push_back(last);
+        }
+    }
+
+    void refresh() const {
+        if (!dirty)
+            return;
+        sorted.clear();
+        sortedWeight = 0.0;
+        sortedSum = 0.0;
+        for (size_t h = 0; h < levels.size(); h++) {
+            double w = std::ldexp(1.0, static_cast<int>(h));
+            for (double v : levels[h]) {
+                sorted.emplace_back(v, w);
+                sortedWeight += w;
+                sortedSum += v * w;
+            }
+        }
+        std::sort(sorted.begin(), sorted.end());
+        dirty = false;
+    }
+
+public:
+    explicit QuantileSketch(size_t k_ = 200)
+        : k(std::max<size_t>(k_, 8)), levels(1), held(0), limit(0), n(0), sum(0.0),
+          minValue(std::numeric_limits<double>::infinity()),
+          maxValue(-std::numeric_limits<double>::infinity()),
+          coin(0x9E3779B97F4A7C15ull), dirty(true), sortedWeight(0.0), sortedSum(0.0) {
+        limit = capacity(0);
+    }
+
+    // Change the accuracy; the sketch is emptied.
+    void setAccuracy(size_t k_) {
+        k = std::max<size_t>(k_, 8);
+        levels.assign(1, std::vector<double>());
+        limit = capacity(0);
+        clear();
+    }
+
+    // Empty the sketch, keeping its buffers.
+    void clear() {
+        for (auto &level : levels)
+            level.clear();
+        held = 0;
+        n = 0;
+        sum = 0.0;
+        minValue = std::numeric_limits<double>::infinity();
+        maxValue = -std::numeric_limits<double>::infinity();
+        dirty = true;
+    }
+
+    void insert(double x) {
+        levels[0].push_back(x);
+        held++;
+        n++;
+        sum += x;
+        minValue = std::min(minValue, x);
+        maxValue = std::max(maxValue, x);
+        dirty = true;
+        if (held >= limit)
+            compress();
+    }
+
+    // Insert x with an integer weight (e.g. a quantity sold at price x): each set
+    // bit b of the weight places one copy at level b.
+    void insert(double x, uint64_t weight) {
+        if (weight == 0)
+            return;
+        for (size_t b = 0; (weight >> b) != 0; b++) {
+            if ((weight >> b) & 1) {
+                ensureLevel(b);
+                levels[b].push_back(x);
+                held++;
+            }
+        }
+        n += weight;
+        sum += x * static_cast<double>(weight);
+        minValue = std::min(minValue, x);
+        maxValue = std::max(maxValue, x);
+        dirty = true;
+        compress();
+    }
+
+    // Fold another sketch into this one.
+    void merge(const QuantileSketch &other) {
+        if (other.n == 0)
+            return;
+        ensureLevel(other.levels.size() - 1);
+        for (size_t h = 0; h < other.levels.size(); h++)
+            levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+        held += other.held;
+        n += other.n;
+        sum += other.sum;
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+        dirty = true;
+        compress();
+    }
+
+    uint64_t count() const { return n; }
+    double total() const { return sum; }
+    double mean() const { return n > 0 ? sum / static_cast<double>(n) : 0.0; }
+    double min() const { return n > 0 ? minValue : 0.0; }
+    double max() const { return n > 0 ? maxValue : 0.0; }
+    size_t retained() const { return held; }
+
+    // Value below which a fraction q of the weight lies.
+    double quantile(double q) const {
+        if (n == 0)
+            return 0.0;
+        if (q <= 0.0)
+            return minValue;
+        if (q >= 1.0)
+            return maxValue;
+        refresh();
+        double target = q * sortedWeight;
+        double cumulative = 0.0;
+        for (const auto &item : sorted) {
+            cumulative += item.second;
+            if (cumulative >= target)
+                return item.first;
+        }
+        return maxValue;
+    }
+
+    // Gini coefficient of the retained weighted sample (Lorenz-curve area).
+    double gini() const {
+        refresh();
+        if (sorted.empty() || sortedSum <= 0.0)
+            return 0.0;
+        double cumulative = 0.0, area = 0.0;
+        for (const auto &item : sorted) {
+            double share = item.first * item.second;
+            area += item.second * (2.0 * cumulative + share);
+            cumulative += share;
+        }
+        return 1.0 - area / (sortedWeight * sortedSum);
+    }
+
+    // Share of the total held by the top `fraction` of the weight (e.g. 0.1 = top decile).
+    double topShare(double fraction) const {
+        refresh();
+        if (sorted.empty() || sortedSum <= 0.0)
+            return 0.0;
+        double remaining = fraction * sortedWeight;
+        double top = 0.0;
+        for (auto it = sorted.rbegin(); it != sorted.rend() && remaining > 0.0; ++it) {
+            double w = std::min(it->second, remaining);
+            top += it->first * w;
+            remaining -= w;
+        }
+        return top / sortedSum;
+    }
+};
+
+#endif // QUANTILESKETCH_H
@@ -0,0 +1,210 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Live telemetry: each cycle's indicators published into a POSIX shared-memory
+// ring buffer, so a local reader can tail a run without touching disk.
+//
+// One writer (the simulation thread) and any number of readers. Every slot carries
+// a sequence number used as a seqlock: the writer makes it odd, writes the values,
+// then sets it to 2 * (record index + 1), and finally advances `published`. A
+// reader copies a slot and keeps it only if the sequence was the expected even
+// value before and after the copy. The writer therefore never waits, and a slow
+// reader only loses records that were overwritten (it can tell how many).
+
+constexpr uint32_t telemetryFields = 16;
+
+struct TelemetrySlot {
+    std::atomic<uint64_t> sequence;
+    double values[telemetryFields];
+};
+
+struct TelemetryHeader {
+    char magic[8];                          // "FVTELEM1"
+    uint32_t version;
+    uint32_t capacity;                      // Slots in the ring
+    uint32_t fields;                        // Values used per record
+    int32_t pid;                            // Writer process
+    char names[telemetryFields][24];        // Field names
+    std::atomic<uint64_t> published;        // Records published so far
+    std::atomic<uint32_t> finished;         // 1 once the run has ended
+    uint32_t reserved;
+};
+
+namespace telemetry {
+
+inline size_t segmentBytes(uint32_t capacity) {
+    return sizeof(TelemetryHeader) + static_cast<size_t>(capacity) * sizeof(TelemetrySlot);
+}
+
+// Shared-memory names must start with a single '/'.
+inline std::string segmentName(const std::string &name) {
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+} // namespace telemetry
+
+class TelemetryWriter {
+private:
+    std::string name;
+    TelemetryHeader *header;
+    TelemetrySlot *slots;
+    size_t bytes;
+
+public:
+    // Create (or replace) the named segment with room for `capacity` records.
+    TelemetryWriter(const std::string &segment, const std::vector<std::string> &fields, uint32_t capacity = 4096)
+        : name(telemetry::segmentName(segment)), header(nullptr), slots(nullptr), bytes(0)
+    {
+        capacity = std::max<uint32_t>(capacity, 2);
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return;
+        bytes = telemetry::segmentBytes(capacity);
+        void *m = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) == 0)
+            m = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (m == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            return;
+        }
+        header = static_cast<TelemetryHeader *>(m);
+        slots = reinterpret_cast<TelemetrySlot *>(header + 1);
+        header->version = 1;
+        header->capacity = capacity;
+        header->fields = static_cast<uint32_t>(std::min<size_t>(fields.size(), telemetryFields));
+        header->pid = static_cast<int32_t>(::getpid());
+        std::memset(header->names, 0, sizeof(header->names));
+        for (uint32_t f = 0; f < header->fields; f++)
+            std::memcpy(header->names[f], fields[f].data(), std::min<size_t>(fields[f].size(), 23));
+        header->published.store(0, std::memory_order_relaxed);
+        header->finished.store(0, std::memory_order_relaxed);
+        for (uint32_t s = 0; s < capacity; s++)
+            slots[s].sequence.store(0, std::memory_order_relaxed);
+        // The magic is written last: a reader that sees it sees an initialised header.
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, "FVTELEM1", 8);
+    }
+
+    ~TelemetryWriter() { close(); }
+
+    TelemetryWriter(const TelemetryWriter &) = delete;
+    TelemetryWriter &operator=(const TelemetryWriter &) = delete;
+
+    bool isOpen() const { return header != nullptr; }
+    const std::string &getName() const { return name; }
+
+    // Publish one record (values beyond the declared fields are ignored).
+    void publish(const double *values, size_t count) {
+        if (!header)
+            return;
+        uint64_t index = header->published.load(std::memory_order_relaxed);
+        TelemetrySlot &slot = slots[index % header->capacity];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        size_t n = std::min<size_t>(count, header->fields);
+        std::memcpy(slot.values, values, n * sizeof(double));
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        header->published.store(index + 1, std::memory_order_release);
+    }
+
+    // Unmap without removing the segment (e.g. a forked child leaving its parent's feed).
+    void detach() {
+        if (header)
+            ::munmap(header, bytes);
+        header = nullptr;
+        slots = nullptr;
+    }
+
+    // Mark the run finished and remove the name; mapped readers keep their view.
+    void close() {
+        if (!header)
+            return;
+        header->finished.store(1, std::memory_order_release);
+        detach();
+        ::shm_unlink(name.c_str());
+    }
+};
+
+class TelemetryReader {
+private:
+    const TelemetryHeader *header;
+    const TelemetrySlot *slots;
+    size_t bytes;
+
+public:
+    explicit TelemetryReader(const std::string &segment) : header(nullptr), slots(nullptr), bytes(0) {
+        int fd = ::shm_open(telemetry::segmentName(segment).c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return;
+        struct stat st;
+        void *m = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(TelemetryHeader))) {
+            bytes = static_cast<size_t>(st.st_size);
+            m = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (m == MAP_FAILED)
+            return;
+        header = static_cast<const TelemetryHeader *>(m);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (std::memcmp(header->magic, "FVTELEM1", 8) != 0
+            || bytes < telemetry::segmentBytes(header->capacity)) {
+            ::munmap(const_cast<TelemetryHeader *>(header), bytes);
+            header = nullptr;
+            return;
+        }
+        slots = reinterpret_cast<const TelemetrySlot *>(header + 1);
+    }
+
+    ~TelemetryReader() {
+        if (header)
+            ::munmap(const_cast<TelemetryHeader *>(header), bytes);
+    }
+
+    TelemetryReader(const TelemetryReader &) = delete;
+    TelemetryReader &operator=(const TelemetryReader &) = delete;
+
+    bool isOpen() const { return header != nullptr; }
+    uint64_t published() const { return header->published.load(std::memory_order_acquire); }
+    bool finished() const { return header->finished.load(std::memory_order_acquire) != 0; }
+    uint32_t capacity() const { return header->capacity; }
+    int writerPid() const { return header->pid; }
+
+    std::vector<std::string> fields() const {
+        std::vector<std::string> out;
+        for (uint32_t f = 0; f < header->fields; f++)
+            out.push_back(std::string(header->names[f], strnlen(header->names[f], 24)));
+        return out;
+    }
+
+    // Copy record `index` into `out`; false if it is not published yet or was overwritten.
+    bool read(uint64_t index, std::vector<double> &out) const {
+        const TelemetrySlot &slot = slots[index % header->capacity];
+        uint64_t expected = 2 * index + 2;
+        out.resize(header->fields);
+        for (int attempt = 0; attempt < 64; attempt++) {
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before != expected)
+                return false;
+            std::memcpy(out.data(), slot.values, out.size() * sizeof(double));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+        return false;
+    }
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,521 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include "Simulation.h"
+
+// Calibration of SimulationParameters against target series (e.g. a summary CSV such
+// as data/economicdatas.csv).
+//
+// The calibrated parameters are mapped to the unit cube (lower + u (upper - lower))
+// and fitted by Nelder-Mead. Every candidate is a complete in-process Simulation run
+// with the same seed, and the loss averages over the target columns, each scaled by
+// the target's standard deviation:
+//   series   mean over days of ((simulated - target) / scale)^2
+//   moments  ((mean difference)^2 + (sd difference)^2) / scale^2
+// Each iteration evaluates reflection, expansion and both contractions as one batch,
+// in parallel, so an iteration costs one run of wall time with four threads (with a
+// single thread only the points the step needs are run).
+//
+// Early stopping: a candidate only matters if it beats the worst vertex of the
+// simplex. At `checkpoints` evenly spaced days the partial loss is compared with the
+// worst vertex's loss. For series this partial sum is a lower bound of the final
+// loss, so stopping never changes a decision; for moments it is a heuristic, and a
+// candidate is only stopped beyond stopFactor times the threshold. A stopped
+// candidate reports its partial loss.
+//
+// Without common random numbers, turnover and investment draws use the process-wide
+// rand(), which concurrent candidates would share, so the losses would depend on the
+// scheduling. The calibrator therefore turns commonRandomNumbers on whenever it runs
+// more than one thread: every draw is keyed, the losses are reproducible and the
+// candidates differ only by their parameters.
+
+// A SimulationParameters field the calibration may move, within [lower, upper].
+struct CalibratedParameter {
+    std::string name;
+    double SimulationParameters::*field;
+    double lower;
+    double upper;
+};
+
+// The behavioural parameters that can be calibrated, with their default bounds.
+inline const std::vector<CalibratedParameter> &calibratableParameters() {
+    static const std::vector<CalibratedParameter> all = {
+        {"initialWage", &SimulationParameters::initialWage, 2.0, 10.0},
+        {"annualBirthRate", &SimulationParameters::annualBirthRate, 0.0, 0.10},
+        {"offeredPriceMean", &SimulationParameters::offeredPriceMean, 3.0, 8.0},
+        {"perceivedPriceMean", &SimulationParameters::perceivedPriceMean, 3.0, 8.0},
+        {"pQuit", &SimulationParameters::pQuit, 0.0, 0.30},
+        {"employeeEfficiency", &SimulationParameters::employeeEfficiency, 1.0, 4.0},
+        {"priceFloor", &SimulationParameters::priceFloor, 0.0, 6.0},
+    };
+    return all;
+}
+
+// Set a parameter by name: a calibratable parameter, or an engine or feature switch.
+// Returns false for an unknown name.
+inline bool setParameter(SimulationParameters &p, const std::string &name, double value) {
+    for (const auto &par : calibratableParameters()) {
+        if (par.name == name) {
+            p.*(par.field) = value;
+            return true;
+        }
+    }
+    static const std::vector<std::pair<const char *, int SimulationParameters::*>> integers = {
+        {"marketThreads", &SimulationParameters::marketThreads},
+        {"cycleThreads", &SimulationParameters::cycleThreads},
+        {"settlementThreads", &SimulationParameters::settlementThreads},
+        {"networkThreads", &SimulationParameters::networkThreads},
+        {"groundThreads", &SimulationParameters::groundThreads},
+        {"sketchK", &SimulationParameters::sketchK},
+        {"capitalFirms", &SimulationParameters::capitalFirms},
+        {"groundWidth", &SimulationParameters::groundWidth},
+        {"shelfLife", &SimulationParameters::shelfLife},
+    };
+    for (const auto &entry : integers) {
+        if (name == entry.first) {
+            p.*(entry.second) = static_cast<int>(value);
+            return true;
+        }
+    }
+    if (name == "banking") {
+        p.banking = value != 0.0;
+        return true;
+    }
+    if (name == "commonRandomNumbers") {
+        p.commonRandomNumbers = value != 0.0;
+        return true;
+    }
+    return false;
+}
+
+// Apply "name=value,name=value,..." to p.
+inline bool applyParameterChanges(SimulationParameters &p, const std::string &changes) {
+    std::stringstream ss(changes);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty())
+            continue;
+        size_t eq = item.find('=');
+        if (eq == std::string::npos || !setParameter(p, item.substr(0, eq), std::atof(item.substr(eq + 1).c_str()))) {
+            std::cerr << "Error: Unknown parameter change " << item << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Simulated series that can be fitted, named as in the summary CSV.
+inline int calibrationSeries(const std::string &column) {
+    static const char *names[] = {"DailyGDP", "Population", "GDPperCapita", "Unemployment",
+                                  "Inflation", "FishPrice"};
+    for (int k = 0; k < 6; k++)
+        if (column == names[k])
+            return k;
+    return -1;
+}
+
+inline double simulatedValue(const Simulation &sim, int series, size_t day) {
+    switch (series) {
+        case 0: return sim.getGDPs()[day];
+        case 1: return static_cast<double>(sim.getPopulations()[day]);
+        case 2: return sim.getGDPperCapitas()[day];
+        case 3: return sim.getUnemploymentRates()[day];
+        case 4: return sim.getInflations()[day] * 100;
+        default: return sim.getFishPrices()[day];
+    }
+}
+
+// Target columns read from a CSV with a header row.
+struct CalibrationTarget {
+    std::vector<std::string> columns;
+    std::vector<int> series;                  // Per column (see calibrationSeries)
+    std::vector<std::vector<double>> values;  // Per column, per day
+    std::vector<double> mean;                 // Per column
+    std::vector<double> sd;                   // Per column
+    std::vector<double> scale;                // Per column: sd, or 1 for a flat target
+
+    size_t days() const { return values.empty() ? 0 : values[0].size(); }
+
+    bool load(const std::string &path, const std::vector<std::string> &wanted) {
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            std::cerr << "Error: Unable to open calibration target " << path << "\n";
+            return false;
+        }
+        std::string line, cell;
+        std::getline(in, line);
+        std::vector<std::string> header;
+        std::stringstream hs(line);
+        while (std::getline(hs, cell, ','))
+            header.push_back(cell);
+        std::vector<size_t> index;
+        columns.clear();
+        series.clear();
+        for (const auto &name : wanted) {
+            auto it = std::find(header.begin(), header.end(), name);
+            if (it == header.end() || calibrationSeries(name) < 0) {
+                std::cerr << "Error: Column " << name << " cannot be calibrated against " << path << "\n";
+                return false;
+            }
+            index.push_back(static_cast<size_t>(it - header.begin()));
+            columns.push_back(name);
+            series.push_back(calibrationSeries(name));
+        }
+        values.assign(columns.size(), std::vector<double>());
+        while (std::getline(in, line)) {
+            if (line.empty())
+                continue;
+            std::vector<std::string> cells;
+            std::stringstream ls(line);
+            while (std::getline(ls, cell, ','))
+                cells.push_back(cell);
+            for (size_t c = 0; c < index.size(); c++)
+                values[c].push_back(index[c] < cells.size() ? std::atof(cells[index[c]].c_str()) : 0.0);
+        }
+        mean.assign(columns.size(), 0.0);
+        sd.assign(columns.size(), 0.0);
+        scale.assign(columns.size(), 1.0);
+        for (size_t c = 0; c < columns.size(); c++) {
+            moments(values[c], values[c].size(), mean[c], sd[c]);
+            if (sd[c] > 1e-12)
+                scale[c] = sd[c];
+        }
+        return days() > 0;
+    }
+
+    static void moments(const std::vector<double> &x, size_t n, double &m, double &s) {
+        m = 0.0;
+        s = 0.0;
+        if (n == 0)
+            return;
+        for (size_t t = 0; t < n; t++)
+            m += x[t];
+        m /= static_cast<double>(n);
+        for (size_t t = 0; t < n; t++)
+            s += (x[t] - m) * (x[t] - m);
+        s = std::sqrt(s / static_cast<double>(n));
+    }
+};
+
+// One Nelder-Mead iteration of the convergence trace.
+struct CalibrationStep {
+    int iteration;
+    const char *move;           // "init", "reflect", "expand", "contract-out", "contract-in", "shrink"
+    size_t evaluations;         // Runs so far
+    size_t stopped;             // Runs stopped early so far
+    double bestLoss;
+    double worstLoss;
+    std::vector<double> best;   // Best parameter values
+};
+
+class Calibrator {
+private:
+    SimulationParameters base;
+    CalibrationTarget target;
+    std::vector<CalibratedParameter> parameters;
+    bool useMoments;
+    int threads;
+    int checkpoints;
+    double stopFactor;
+
+    size_t evaluations;
+    size_t stopped;
+    std::vector<CalibrationStep> trace;
+    std::vector<double> bestPoint;   // Unit cube
+    double bestLoss;
+
+    static double clamp01(double v) { return std::min(std::max(v, 0.0), 1.0); }
+
+    double momentsLoss(const Simulation &sim, size_t n) const {
+        double total = 0.0;
+        std::vector<double> x(n);
+        for (size_t c = 0; c < target.columns.size(); c++) {
+            for (size_t t = 0; t < n; t++)
+                x[t] = simulatedValue(sim, target.series[c], t);
+            double m, s;
+            CalibrationTarget::moments(x, n, m, s);
+            double dm = (m - target.mean[c]) / target.scale[c];
+            double ds = (s - target.sd[c]) / target.scale[c];
+            total += dm * dm + ds * ds;
+        }
+        return total / static_cast<double>(target.columns.size());
+    }
+
+public:
+    Calibrator(const SimulationParameters &base_, const CalibrationTarget &target_,
+               const std::vector<CalibratedParameter> &parameters_, bool moments = false,
+               int threads_ = 1, int checkpoints_ = 4, double stopFactor_ = 2.0)
+        : base(base_),
+          target(target_),
+          parameters(parameters_),
+          useMoments(moments),
+          threads(std::max(threads_, 1)),
+          checkpoints(std::max(checkpoints_, 0)),
+          stopFactor(stopFactor_),
+          evaluations(0),
+          stopped(0),
+          bestLoss(std::numeric_limits<double>::infinity())
+    {
+        base.totalCycles = static_cast<int>(target.days());
+        if (threads > 1)
+            base.commonRandomNumbers = true;
+    }
+
+    // Parameters of the point u of the unit cube.
+    SimulationParameters candidate(const std::vector<double> &u) const {
+        SimulationParameters p = base;
+        for (size_t k = 0; k < parameters.size(); k++) {
+            const auto &par = parameters[k];
+            p.*(par.field) = par.lower + clamp01(u[k]) * (par.upper - par.lower);
+        }
+        return p;
+    }
+
+    std::vector<double> toUnit(const SimulationParameters &p) const {
+        std::vector<double> u(parameters.size());
+        for (size_t k = 0; k < parameters.size(); k++) {
+            const auto &par = parameters[k];
+            double width = par.upper - par.lower;
+            u[k] = width > 0.0 ? clamp01((p.*(par.field) - par.lower) / width) : 0.0;
+        }
+        return u;
+    }
+
+    // Run one candidate; stop it early (early = true) once it cannot beat `threshold`.
+    double evaluate(const std::vector<double> &u, double threshold, bool &early) const {
+        early = false;
+        Simulation sim(candidate(u));
+        const size_t days = target.days();
+        const size_t columns = target.columns.size();
+        const size_t interval = checkpoints > 0 ? std::max<size_t>(days / (checkpoints + 1), 1) : days + 1;
+        size_t nextCheck = interval;
+        size_t seen = 0;
+        double squares = 0.0;   // Series: running sum of the scaled squared errors
+        while (!sim.finished()) {
+            sim.advance();
+            size_t day = std::min(static_cast<size_t>(sim.getDay()), days);
+            if (!useMoments) {
+                for (size_t c = 0; c < columns; c++) {
+                    for (size_t t = seen; t < day; t++) {
+                        double d = (simulatedValue(sim, target.series[c], t) - target.values[c][t]) / target.scale[c];
+                        squares += d * d;
+                    }
+                }
+            }
+            seen = day;
+            if (day >= nextCheck && day < days && std::isfinite(threshold)) {
+                nextCheck += interval;
+                double partial = useMoments
+                    ? momentsLoss(sim, day)
+                    : squares / static_cast<double>(days * columns);
+                if (partial > (useMoments ? stopFactor * threshold : threshold)) {
+                    early = true;
+                    return partial;
+                }
+            }
+        }
+        return useMoments ? momentsLoss(sim, seen) : squares / static_cast<double>(days * columns);
+    }
+
+    // Evaluate a batch of points on the worker threads (each takes the next point).
+    std::vector<double> evaluateBatch(const std::vector<std::vector<double>> &points, double threshold) {
+        std::vector<double> loss(points.size(), 0.0);
+        std::vector<char> early(points.size(), 0);
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < points.size(); i = next++) {
+                bool e = false;
+                loss[i] = evaluate(points[i], threshold, e);
+                early[i] = e;
+            }
+        };
+        size_t workers = std::min(static_cast<size_t>(threads), points.size());
+        std::vector<std::thread> pool;
+        for (size_t w = 1; w < workers; w++)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &t : pool)
+            t.join();
+        evaluations += points.size();
+        for (char e : early)
+            stopped += e ? 1 : 0;
+        return loss;
+    }
+
+    // Nelder-Mead from the base parameters. Stops after maxIterations, or once the
+    // losses of the simplex are within `tolerance` of each other and its vertices
+    // within `tolerance` of the best one (in unit-cube coordinates).
+    void run(int maxIterations, double tolerance) {
+        const size_t n = parameters.size();
+        const double inf = std::numeric_limits<double>::infinity();
+        trace.clear();
+        evaluations = 0;
+        stopped = 0;
+        if (n == 0 || target.columns.empty())
+            return;
+
+        // Initial simplex: the base point and a quarter step along each axis.
+        std::vector<std::vector<double>> simplex(n + 1, toUnit(base));
+        for (size_t k = 0; k < n; k++)
+            simplex[k + 1][k] += (simplex[k + 1][k] + 0.25 <= 1.0) ? 0.25 : -0.25;
+        std::vector<double> f = evaluateBatch(simplex, inf);
+        const char *move = "init";
+
+        for (int iteration = 0; ; iteration++) {
+            std::vector<size_t> order(n + 1);
+            for (size_t i = 0; i <= n; i++)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return f[a] < f[b]; });
+            std::vector<std::vector<double>> sortedSimplex(n + 1);
+            std::vector<double> sortedF(n + 1);
+            for (size_t i = 0; i <= n; i++) {
+                sortedSimplex[i] = simplex[order[i]];
+                sortedF[i] = f[order[i]];
+            }
+            simplex.swap(sortedSimplex);
+            f.swap(sortedF);
+            bestPoint = simplex[0];
+            bestLoss = f[0];
+
+            CalibrationStep step;
+            step.iteration = iteration;
+            step.move = move;
+            step.evaluations = evaluations;
+            step.stopped = stopped;
+            step.bestLoss = f[0];
+            step.worstLoss = f[n];
+            step.best = getBest();
+            trace.push_back(step);
+
+            double size = 0.0;
+            for (size_t i = 1; i <= n; i++)
+                for (size_t k = 0; k < n; k++)
+                    size = std::max(size, std::fabs(simplex[i][k] - simplex[0][k]));
+            if (iteration >= maxIterations || (f[n] - f[0] <= tolerance && size <= tolerance))
+                break;
+
+            std::vector<double> centroid(n, 0.0);
+            for (size_t i = 0; i < n; i++)
+                for (size_t k = 0; k < n; k++)
+                    centroid[k] += simplex[i][k] / static_cast<double>(n);
+            auto along = [&](double t) {
+                std::vector<double> x(n);
+                for (size_t k = 0; k < n; k++)
+                    x[k] = clamp01(centroid[k] + t * (centroid[k] - simplex[n][k]));
+                return x;
+            };
+            // Reflection, expansion, outside and inside contraction.
+            std::vector<std::vector<double>> trial = {along(1.0), along(2.0), along(0.5), along(-0.5)};
+            std::vector<double> ft(trial.size(), inf);
+            std::vector<char> done(trial.size(), 0);
+            if (threads > 1) {
+                ft = evaluateBatch(trial, f[n]);
+                std::fill(done.begin(), done.end(), 1);
+            }
+            auto value = [&](size_t k) {
+                if (!done[k]) {
+                    ft[k] = evaluateBatch({trial[k]}, f[n])[0];
+                    done[k] = 1;
+                }
+                return ft[k];
+            };
+
+            size_t accepted = trial.size();
+            double fr = value(0);
+            if (fr < f[0]) {
+                accepted = value(1) < fr ? 1 : 0;
+                move = accepted == 1 ? "expand" : "reflect";
+            } else if (fr < f[n - 1]) {
+                accepted = 0;
+                move = "reflect";
+            } else if (fr < f[n]) {
+                accepted = value(2) <= fr ? 2 : 0;
+                move = accepted == 2 ? "contract-out" : "reflect";
+            } else if (value(3) < f[n]) {
+                accepted = 3;
+                move = "contract-in";
+            }
+            if (accepted < trial.size()) {
+                simplex[n] = trial[accepted];
+                f[n] = ft[accepted];
+            } else {
+                // Shrink toward the best vertex; these runs are kept whatever their loss.
+                std::vector<std::vector<double>> shrunk(simplex.begin() + 1, simplex.end());
+                for (auto &x : shrunk)
+                    for (size_t k = 0; k < n; k++)
+                        x[k] = simplex[0][k] + 0.5 * (x[k] - simplex[0][k]);
+                std::vector<double> fs = evaluateBatch(shrunk, inf);
+                for (size_t i = 1; i <= n; i++) {
+                    simplex[i] = shrunk[i - 1];
+                    f[i] = fs[i - 1];
+                }
+                move = "shrink";
+            }
+        }
+    }
+
+    // Best parameter values found (in parameter units).
+    std::vector<double> getBest() const {
+        std::vector<double> values(parameters.size(), 0.0);
+        if (bestPoint.size() != parameters.size())
+            return values;
+        SimulationParameters p = candidate(bestPoint);
+        for (size_t k = 0; k < parameters.size(); k++)
+            values[k] = p.*(parameters[k].field);
+        return values;
+    }
+    SimulationParameters getBestParameters() const { return candidate(bestPoint); }
+    double getBestLoss() const { return bestLoss; }
+    size_t getEvaluations() const { return evaluations; }
+    size_t getStopped() const { return stopped; }
+    const std::vector<CalibrationStep> &getTrace() const { return trace; }
+
+    // "Parameter,Value" rows for the best fit, followed by its loss.
+    bool writeBest(const std::string &path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Error: Unable to open file for writing the best fit " << path << "\n";
+            return false;
+        }
+        out << "Parameter,Value\n";
+        std::vector<double> best = getBest();
+        for (size_t k = 0; k < parameters.size(); k++)
+            out << parameters[k].name << "," << best[k] << "\n";
+        out << "Loss," << bestLoss << "\n";
+        return true;
+    }
+
+    // Convergence trace, one row per iteration.
+    bool writeTrace(const std::string &path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Error: Unable to open file for writing the calibration trace " << path << "\n";
+            return false;
+        }
+        out << "Iteration,Move,Evaluations,Stopped,BestLoss,WorstLoss";
+        for (const auto &par : parameters)
+            out << "," << par.name;
+        out << "\n";
+        for (const auto &step : trace) {
+            out << step.iteration << "," << step.move << "," << step.evaluations << "," << step.stopped
+                << "," << step.bestLoss << "," << step.worstLoss;
+            for (double v : step.best)
+                out << "," << v;
+            out << "\n";
+        }
+        return true;
+    }
+};
+
+#endif // CALIBRATION_H
@@ -0,0 +1,111 @@
+#ifndef EMPLOYMENTINDEX_H
+#define EMPLOYMENTINDEX_H
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "FisherMan.h"
+#include "Firm.h"
+#include "TaskAccess.h"
+
+// Bidirectional employer-employee index.
+// Each firm owns a slot holding a dense array of its workers; each worker stores
+// its firm slot and its position in that array. Hiring appends, quitting (or dying)
+// swaps the worker with the last one of the array, so both are O(1), and the firm's
+// numberOfEmployees always equals the size of its array.
+class EmploymentIndex {
+private:
+    struct Slot {
+        std::shared_ptr<Firm> firm;       // nullptr once the firm has been removed
+        std::vector<FisherMan*> workers;  // Dense array of employees
+    };
+
+    std::vector<Slot> slots;
+    std::unordered_map<int, int> slotOfFirm;  // firmID -> slot
+
+public:
+    // Register a firm and return its slot.
+    int addFirm(std::shared_ptr<Firm> firm) {
+        TaskAccess::touch(this, true);
+        int slot = static_cast<int>(slots.size());
+        slotOfFirm[firm->getID()] = slot;
+        firm->setNumberOfEmployees(0);
+        slots.push_back({firm, {}});
+        return slot;
+    }
+
+    // Release every worker of a firm and retire its slot.
+    void removeFirm(int firmID) {
+        TaskAccess::touch(this, true);
+        auto it = slotOfFirm.find(firmID);
+        if (it == slotOfFirm.end())
+            return;
+        Slot &slot = slots[it->second];
+        for (FisherMan *worker : slot.workers) {
+            worker->setEmployed(false);
+            worker->setEmployerSlot(-1, 0);
+        }
+        slot.workers.clear();
+        slot.firm.reset();
+        slotOfFirm.erase(it);
+    }
+
+    // Employ a fisherman at the given firm. Returns false if the firm is unknown.
+    bool hire(FisherMan *worker, int firmID, money_t wage) {
+        TaskAccess::touch(this, true);
+        auto it = slotOfFirm.find(firmID);
+        if (it == slotOfFirm.end())
+            return false;
+        if (worker->getEmployerSlot() >= 0)
+            quit(worker);
+        Slot &slot = slots[it->second];
+        worker->setEmployerSlot(it->second, slot.workers.size());
+        worker->setEmployed(true);
+        worker->setWage(wage);
+        slot.workers.push_back(worker);
+        slot.firm->setNumberOfEmployees(static_cast<int>(slot.workers.size()));
+        return true;
+    }
+
+    // Remove a fisherman from his employer (quit or death).
+    void quit(FisherMan *worker) {
+        TaskAccess::touch(this, true);
+        worker->setEmployed(false);
+        int s = worker->getEmployerSlot();
+        if (s < 0)
+            return;
+        Slot &slot = slots[s];
+        size_t pos = worker->getEmployerPosition();
+        FisherMan *last = slot.workers.back();
+        slot.workers[pos] = last;
+        last->setEmployerSlot(s, pos);
+        slot.workers.pop_back();
+        worker->setEmployerSlot(-1, 0);
+        if (slot.firm)
+            slot.firm->setNumberOfEmployees(static_cast<int>(slot.workers.size()));
+    }
+
+    size_t getSlotCount() const { return slots.size(); }
+
+    // Slot of a firm (-1 if unknown).
+    int getSlot(int firmID) const {
+        TaskAccess::touch(this, false);
+        auto it = slotOfFirm.find(firmID);
+        return it == slotOfFirm.end() ? -1 : it->second;
+    }
+
+    // Bank account of the firm owning a slot (-1 once the firm has been removed).
+    int getFirmAccount(int slot) const {
+        TaskAccess::touch(this, false);
+        const auto &firm = slots[slot].firm;
+        return firm ? firm->getAccount() : -1;
+    }
+
+    // ID of the firm owning a slot (-1 once the firm has been removed).
+    int getFirmID(int slot) const {
+        const auto &firm = slots[slot].firm;
+        return firm ? firm->getID() : -1;
+    }
+};
+
+#endif // EMPLOYMENTINDEX_H
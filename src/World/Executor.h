@@ -0,0 +1,43 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <functional>
+
+// How a parallel phase runs its chunks: executor(n, body) calls body(0..n-1), possibly
+// concurrently, and returns once every call has returned. The World gives its phases
+// (the fish market's partitions, the ledger's settlement, the network's kernels, the
+// ground's stencil, the trace digests) the cycle's work-stealing pool, so no phase
+// starts threads of its own during the day (see World::setCycleThreads).
+using Executor = std::function<void(size_t, const std::function<void(size_t)>&)>;
+
+// Run body(0..n-1) with the executor. Without one (a phase used outside a World), each
+// chunk but the first gets a thread for the call, and the calling thread runs chunk 0.
+inline void runChunks(const Executor &executor, size_t n, const std::function<void(size_t)> &body) {
+    if (n == 0)
+        return;
+    if (executor) {
+        executor(n, body);
+        return;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(n - 1);
+    for (size_t c = 1; c < n; c++)
+        pool.emplace_back([&body, c] { body(c); });
+    body(0);
+    for (auto &t : pool)
+        t.join();
+}
+
+// Run body(begin, end) over [0, n) split into `parts` contiguous ranges.
+template <typename Body>
+void runRanges(const Executor &executor, size_t n, size_t parts, const Body &body) {
+    parts = std::max<size_t>(parts, 1);
+    runChunks(executor, parts, [&body, n, parts](size_t p) {
+        body(n * p / parts, n * (p + 1) / parts);
+    });
+}
+
+#endif // EXECUTOR_H
@@ -0,0 +1,158 @@
+#ifndef FISHINGGROUND_H
+#define FISHINGGROUND_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "TaskAccess.h"
+#include "Executor.h"
+
+// Spatial fishing ground: a width x height grid of cells holding fish biomass.
+//
+// Each day every cell regrows logistically, r b (1 - b / K), and biomass diffuses to
+// the four neighbours, D (N + S + E + W - 4 b), with no flux through the edges:
+//     b' = max(b + D lap(b) + r b (1 - b / K), 0)
+// The stencil reads one buffer and writes the other. Rows are split into bands, one
+// per thread, and each band is swept in column strips so the three rows in use stay
+// in cache on wide grids. The interior loop is branch-free over restrict pointers so
+// the compiler vectorises it (see OPT_FLAGS in the Makefile). D must stay below 0.25
+// for the scheme to be stable.
+//
+// Fisheries (one per fishing firm) own contiguous row-major ranges of cells. A
+// fishery catches at most `catchability` of its biomass per day, taken from its
+// cells in proportion to their biomass.
+class FishingGround {
+private:
+    int width;
+    int height;
+    double capacity;        // K: biomass per cell at saturation
+    double growth;          // r: daily logistic growth rate
+    double diffusion;       // D
+    double catchability;    // Largest share of a fishery's biomass caught per day
+    int threads;
+    size_t fisheries;
+    std::vector<double> biomass;
+    std::vector<double> next;
+
+    static constexpr int stripWidth = 2048;
+
+    Executor executor;      // Runs the bands (see Executor.h)
+
+    template <typename Body>
+    void parallelFor(size_t n, const Body &body) const {
+        runRanges(executor, n, std::min<size_t>(static_cast<size_t>(std::max(threads, 1)), n), body);
+    }
+
+    // Update columns [x0, x1) of row y.
+    void updateRow(int y, int x0, int x1) {
+        const double *__restrict cur = &biomass[static_cast<size_t>(y) * width];
+        const double *__restrict up = (y > 0) ? cur - width : cur;
+        const double *__restrict down = (y + 1 < height) ? cur + width : cur;
+        double *__restrict out = &next[static_cast<size_t>(y) * width];
+        const double d = diffusion, r = growth, invK = 1.0 / capacity;
+        auto cell = [&](int x, double left, double right) {
+            double c = cur[x];
+            double lap = up[x] + down[x] + left + right - 4.0 * c;
+            return std::max(c + d * lap + r * c * (1.0 - c * invK), 0.0);
+        };
+        int lo = std::max(x0, 1), hi = std::min(x1, width - 1);
+        if (x0 == 0)
+            out[0] = cell(0, cur[0], width > 1 ? cur[1] : cur[0]);
+        for (int x = lo; x < hi; x++) {
+            double c = cur[x];
+            double lap = up[x] + down[x] + cur[x - 1] + cur[x + 1] - 4.0 * c;
+            double v = c + d * lap + r * c * (1.0 - c * invK);
+            out[x] = v > 0.0 ? v : 0.0;
+        }
+        if (x1 == width && width > 1)
+            out[width - 1] = cell(width - 1, cur[width - 2], cur[width - 1]);
+    }
+
+    size_t cellsOf(size_t f, size_t &begin) const {
+        size_t cells = biomass.size();
+        begin = cells * f / fisheries;
+        return cells * (f + 1) / fisheries - begin;
+    }
+
+public:
+    FishingGround(int width_, int height_, double capacity_, double growth_, double diffusion_,
+                  double catchability_, int threads_ = 1)
+        : width(std::max(width_, 1)),
+          height(std::max(height_, 1)),
+          capacity(std::max(capacity_, 1e-9)),
+          growth(growth_),
+          diffusion(std::min(std::max(diffusion_, 0.0), 0.25)),
+          catchability(std::min(std::max(catchability_, 0.0), 1.0)),
+          threads(threads_),
+          fisheries(1),
+          biomass(static_cast<size_t>(width) * height, capacity),
+          next(biomass.size(), 0.0)
+    {}
+
+    void setThreads(int t) { threads = t; }
+    void setExecutor(Executor e) { executor = std::move(e); }
+    void setRates(double growth_, double diffusion_, double catchability_) {
+        growth = growth_;
+        diffusion = std::min(std::max(diffusion_, 0.0), 0.25);
+        catchability = std::min(std::max(catchability_, 0.0), 1.0);
+    }
+
+    // Split the ground into n fisheries (contiguous row-major cell ranges).
+    void setFisheries(size_t n) { fisheries = std::max<size_t>(n, 1); }
+    size_t getFisheries() const { return fisheries; }
+
+    // Catch up to desired[f] whole fish from every fishery f (in parallel over
+    // fisheries, whose cells are disjoint); returns the catches.
+    std::vector<double> harvest(const std::vector<double> &desired) {
+        TaskAccess::touch(this, true);
+        std::vector<double> caught(desired.size(), 0.0);
+        size_t n = std::min(desired.size(), fisheries);
+        parallelFor(n, [&](size_t f0, size_t f1) {
+            for (size_t f = f0; f < f1; f++) {
+                if (desired[f] <= 0.0)
+                    continue;
+                size_t begin;
+                size_t count = cellsOf(f, begin);
+                double available = 0.0;
+                for (size_t c = begin; c < begin + count; c++)
+                    available += biomass[c];
+                double take = std::floor(std::min(desired[f], catchability * available));
+                if (take <= 0.0)
+                    continue;
+                double keep = 1.0 - take / available;
+                for (size_t c = begin; c < begin + count; c++)
+                    biomass[c] *= keep;
+                caught[f] = take;
+            }
+        });
+        return caught;
+    }
+
+    // One day of regrowth and diffusion.
+    void step() {
+        TaskAccess::touch(this, true);
+        parallelFor(static_cast<size_t>(height), [&](size_t y0, size_t y1) {
+            for (int x0 = 0; x0 < width; x0 += stripWidth) {
+                int x1 = std::min(width, x0 + stripWidth);
+                for (size_t y = y0; y < y1; y++)
+                    updateRow(static_cast<int>(y), x0, x1);
+            }
+        });
+        biomass.swap(next);
+    }
+
+    double total() const {
+        double sum = 0.0;
+        for (double b : biomass)
+            sum += b;
+        return sum;
+    }
+    // Biomass as a share of the carrying capacity of the whole ground.
+    double getLevel() const { return total() / (capacity * static_cast<double>(biomass.size())); }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const std::vector<double> &getBiomass() const { return biomass; }
+};
+
+#endif // FISHINGGROUND_H
@@ -0,0 +1,376 @@
+#ifndef GOLDENTRACE_H
+#define GOLDENTRACE_H
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include "World.h"
+
+// Golden traces: per-cycle digests of the world, recorded from a reference run and
+// replayed against any engine configuration (threads, storage, money type).
+//
+// At each phase of an agent cycle (see CyclePhase) the world is read into tables of
+// columns (fishermen, firms, fish orders, indicators) and every table is cut into
+// blocks of blockSize rows. A block's digest is a hash of the bit patterns of its
+// rows plus the sum of each column. Replay compares digests as the run goes:
+//   exact      the hashes must match (bit-for-bit identical engines),
+//   tolerance  the row counts must match and each column sum must agree within
+//              abs + rel * max(|reference|, |candidate|) (engines that reorder
+//              floating-point sums).
+// The first mismatch gives the cycle, phase, table and block; the replaying side then
+// keeps that block's rows so the harness can rerun the reference to the same point
+// and name the first differing row (agent) and column. Digesting is parallel over
+// blocks, and a day adds a few hashed words per agent, so the trace of a run costs a
+// small fraction of the run itself.
+
+// A table of the trace: which phase reads it and its columns.
+struct TraceTableSpec {
+    const char *name;
+    CyclePhase phase;
+    std::vector<const char *> columns;
+};
+
+inline const std::vector<TraceTableSpec> &traceTables() {
+    static const std::vector<TraceTableSpec> tables = {
+        {"fishers@wages", CyclePhase::Wages, {"id", "funds", "employer", "age"}},
+        {"firms", CyclePhase::Firms, {"id", "funds", "stock", "price"}},
+        {"fishers@hiring", CyclePhase::Hiring, {"id", "employer"}},
+        {"orders", CyclePhase::FishMarket, {"fill", "spend"}},
+        {"firms@sales", CyclePhase::FishMarket, {"id", "revenue"}},
+        {"fishers@end", CyclePhase::EndOfDay, {"id", "funds", "employer", "daysWithoutEat"}},
+        {"indicators", CyclePhase::EndOfDay, {"gdp", "population", "unemployment", "fishPrice", "inflation"}},
+    };
+    return tables;
+}
+
+inline const char *cyclePhaseName(CyclePhase phase) {
+    static const char *names[] = {"wages", "firms", "hiring", "fish market", "end of day"};
+    return names[static_cast<uint32_t>(phase)];
+}
+
+// Read table t from the world into columns.
+inline void captureTable(const World &world, size_t t, std::vector<std::vector<double>> &columns) {
+    columns.assign(traceTables()[t].columns.size(), std::vector<double>());
+    const auto &fishers = world.getFishers();
+    const auto &firms = world.getFirms();
+    const EmploymentIndex &employment = world.getEmployment();
+    auto employer = [&](const FisherMan &f) {
+        int slot = f.getEmployerSlot();
+        return slot >= 0 ? static_cast<double>(employment.getFirmID(slot)) : -1.0;
+    };
+    switch (t) {
+        case 0:
+        case 2:
+        case 5:
+            for (auto &c : columns)
+                c.reserve(fishers.size());
+            for (const auto &f : fishers) {
+                columns[0].push_back(f->getID());
+                if (t == 2) {
+                    columns[1].push_back(employer(*f));
+                    continue;
+                }
+                columns[1].push_back(toDouble(f->getFunds()));
+                columns[2].push_back(employer(*f));
+                columns[3].push_back(t == 0 ? f->getAge() : f->getDaysWithoutEat());
+            }
+            break;
+        case 1:
+            for (const auto &f : firms) {
+                columns[0].push_back(f->getID());
+                columns[1].push_back(toDouble(f->getFunds()));
+                columns[2].push_back(f->getStock());
+                columns[3].push_back(toDouble(f->getPriceLevel()));
+            }
+            break;
+        case 3: {
+            const auto &market = *world.getFishingMarket();
+            columns[0].assign(market.getOrderFills().begin(), market.getOrderFills().end());
+            for (const auto &spend : market.getOrderSpend())
+                columns[1].push_back(toDouble(spend));
+            columns[1].resize(columns[0].size(), 0.0);
+            break;
+        }
+        case 4:
+            for (const auto &f : firms) {
+                columns[0].push_back(f->getID());
+                columns[1].push_back(toDouble(f->getRevenue()));
+            }
+            break;
+        default:
+            columns[0].push_back(toDouble(world.getGDP()));
+            columns[1].push_back(world.getTotalFishers());
+            columns[2].push_back(world.getUnemploymentRate());
+            columns[3].push_back(world.getFishingMarket()->getClearingFishPrice());
+            columns[4].push_back(world.getInflation());
+            break;
+    }
+}
+
+// Digests of one table at one cycle.
+struct TableDigest {
+    uint32_t cycle = 0;
+    uint32_t table = 0;
+    uint32_t columns = 0;
+    std::vector<uint64_t> hash;   // Per block
+    std::vector<uint32_t> rows;   // Per block
+    std::vector<double> sums;     // Per block, per column
+
+    size_t blocks() const { return hash.size(); }
+
+    void write(std::ostream &out) const {
+        uint32_t head[4] = {cycle, table, columns, static_cast<uint32_t>(blocks())};
+        out.write(reinterpret_cast<const char *>(head), sizeof(head));
+        out.write(reinterpret_cast<const char *>(hash.data()), static_cast<std::streamsize>(hash.size() * sizeof(uint64_t)));
+        out.write(reinterpret_cast<const char *>(rows.data()), static_cast<std::streamsize>(rows.size() * sizeof(uint32_t)));
+        out.write(reinterpret_cast<const char *>(sums.data()), static_cast<std::streamsize>(sums.size() * sizeof(double)));
+    }
+
+    bool read(std::istream &in) {
+        uint32_t head[4];
+        if (!in.read(reinterpret_cast<char *>(head), sizeof(head)))
+            return false;
+        cycle = head[0];
+        table = head[1];
+        columns = head[2];
+        hash.resize(head[3]);
+        rows.resize(head[3]);
+        sums.resize(static_cast<size_t>(head[3]) * columns);
+        in.read(reinterpret_cast<char *>(hash.data()), static_cast<std::streamsize>(hash.size() * sizeof(uint64_t)));
+        in.read(reinterpret_cast<char *>(rows.data()), static_cast<std::streamsize>(rows.size() * sizeof(uint32_t)));
+        in.read(reinterpret_cast<char *>(sums.data()), static_cast<std::streamsize>(sums.size() * sizeof(double)));
+        return static_cast<bool>(in);
+    }
+};
+
+// Digest columns in blocks of blockSize rows, in parallel over blocks.
+inline void digestTable(const std::vector<std::vector<double>> &columns, size_t blockSize, int threads,
+                        TableDigest &d, const Executor &executor = nullptr) {
+    const size_t n = columns.empty() ? 0 : columns[0].size();
+    const size_t m = columns.size();
+    const size_t blocks = std::max<size_t>((n + blockSize - 1) / blockSize, 1);
+    d.columns = static_cast<uint32_t>(m);
+    d.hash.assign(blocks, 0);
+    d.rows.assign(blocks, 0);
+    d.sums.assign(blocks * m, 0.0);
+    auto body = [&](size_t b0, size_t b1) {
+        for (size_t b = b0; b < b1; b++) {
+            size_t r0 = b * blockSize, r1 = std::min(n, r0 + blockSize);
+            uint64_t h = 0xcbf29ce484222325ULL ^ (r1 > r0 ? r1 - r0 : 0);
+            for (size_t r = r0; r < r1; r++) {
+                for (size_t c = 0; c < m; c++) {
+                    double v = columns[c][r];
+                    uint64_t bits;
+                    std::memcpy(&bits, &v, sizeof(bits));
+                    h = (h ^ bits) * 0x100000001b3ULL;
+                    h ^= h >> 29;
+                    d.sums[b * m + c] += v;
+                }
+            }
+            d.hash[b] = h;
+            d.rows[b] = static_cast<uint32_t>(r1 > r0 ? r1 - r0 : 0);
+        }
+    };
+    runRanges(executor, blocks, std::min<size_t>(static_cast<size_t>(std::max(threads, 1)), blocks / 4), body);
+}
+
+// Settings of the run a trace was recorded from.
+struct TraceHeader {
+    char magic[8] = {'F', 'V', 'T', 'R', 'A', 'C', 'E', '1'};
+    uint32_t seed = 0;
+    uint32_t fishers = 0;
+    uint32_t days = 0;
+    uint32_t blockSize = 4096;
+    uint32_t commonRandomNumbers = 0;
+    uint32_t settingsLength = 0;   // Followed by the settings string ("name=value,...")
+};
+
+// Where a replay first departed from the trace.
+struct TraceDivergence {
+    bool found = false;
+    std::string reason;
+    uint32_t cycle = 0;
+    uint32_t table = 0;
+    size_t block = 0;
+    int column = -1;              // First column whose sum disagrees (-1 = hash only)
+    double reference = 0.0;       // That column's sums
+    double candidate = 0.0;
+    std::vector<std::vector<double>> rows;   // Candidate's rows of the block (per column)
+};
+
+// Records digests to a trace file, or replays a run against one.
+class TraceRecorder : public CycleObserver {
+private:
+    bool recording;
+    size_t blockSize;
+    int threads;
+    double relTolerance;   // < 0: exact
+    double absTolerance;
+    std::ofstream out;
+    std::ifstream in;
+    TraceDivergence divergence;
+    uint64_t compared;     // Tables compared (or recorded)
+    std::vector<std::vector<double>> columns;
+    Executor executor;     // Set by the World: runs the digests' ranges on the cycle's pool
+
+    bool matches(const TableDigest &ref, const TableDigest &cand, size_t &block, int &column) const {
+        for (block = 0; block < std::max(ref.blocks(), cand.blocks()); block++) {
+            if (block >= ref.blocks() || block >= cand.blocks() || ref.rows[block] != cand.rows[block])
+                return false;
+            bool same = relTolerance < 0.0 ? ref.hash[block] == cand.hash[block] : true;
+            for (size_t c = 0; c < ref.columns; c++) {
+                double a = ref.sums[block * ref.columns + c], b = cand.sums[block * ref.columns + c];
+                bool close = relTolerance < 0.0
+                    ? a == b
+                    : std::fabs(a - b) <= absTolerance + relTolerance * std::max(std::fabs(a), std::fabs(b));
+                if (!close) {
+                    column = static_cast<int>(c);
+                    return false;
+                }
+            }
+            if (!same) {
+                column = -1;
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    // Record: open `path` for writing and write the header.
+    TraceRecorder(const std::string &path, const TraceHeader &header, const std::string &settings, int threads_ = 1)
+        : recording(true), blockSize(std::max<uint32_t>(header.blockSize, 1)), threads(threads_),
+          relTolerance(-1.0), absTolerance(0.0), compared(0)
+    {
+        out.open(path, std::ios::binary);
+        if (!out.is_open()) {
+            std::cerr << "Error: Unable to open trace " << path << " for writing\n";
+            return;
+        }
+        TraceHeader h = header;
+        h.settingsLength = static_cast<uint32_t>(settings.size());
+        out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        out.write(settings.data(), static_cast<std::streamsize>(settings.size()));
+    }
+
+    // Replay: open `path` and read its header (see readHeader).
+    TraceRecorder(const std::string &path, double rel, double abs, int threads_ = 1)
+        : recording(false), blockSize(4096), threads(threads_), relTolerance(rel), absTolerance(abs), compared(0)
+    {
+        in.open(path, std::ios::binary);
+        if (!in.is_open())
+            std::cerr << "Error: Unable to open trace " << path << "\n";
+    }
+
+    bool isOpen() const { return recording ? out.is_open() : in.is_open(); }
+
+    bool readHeader(TraceHeader &header, std::string &settings) {
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header))
+            || std::memcmp(header.magic, "FVTRACE1", 8) != 0) {
+            std::cerr << "Error: Not a trace file\n";
+            return false;
+        }
+        settings.assign(header.settingsLength, '\0');
+        in.read(&settings[0], header.settingsLength);
+        blockSize = std::max<uint32_t>(header.blockSize, 1);
+        return static_cast<bool>(in);
+    }
+
+    virtual void setExecutor(Executor e) override { executor = std::move(e); }
+
+    virtual void observe(const World &world, CyclePhase phase) override {
+        if (divergence.found)
+            return;
+        const auto &tables = traceTables();
+        for (size_t t = 0; t < tables.size(); t++) {
+            if (tables[t].phase != phase)
+                continue;
+            captureTable(world, t, columns);
+            TableDigest d;
+            d.cycle = static_cast<uint32_t>(world.getCurrentCycle());
+            d.table = static_cast<uint32_t>(t);
+            digestTable(columns, blockSize, threads, d, executor);
+            compared++;
+            if (recording) {
+                d.write(out);
+                continue;
+            }
+            TableDigest ref;
+            if (!ref.read(in)) {
+                divergence.found = true;
+                divergence.reason = "the trace ends before this run";
+            } else if (ref.cycle != d.cycle || ref.table != d.table) {
+                divergence.found = true;
+                divergence.reason = "the trace was recorded with a different schedule (cycle "
+                    + std::to_string(ref.cycle + 1) + ", table " + std::string(tables[ref.table % tables.size()].name) + ")";
+            } else if (!matches(ref, d, divergence.block, divergence.column)) {
+                divergence.found = true;
+                divergence.reason = "digest mismatch";
+                if (divergence.column >= 0) {
+                    divergence.reference = ref.sums[divergence.block * ref.columns + divergence.column];
+                    divergence.candidate = d.sums[divergence.block * d.columns + divergence.column];
+                }
+                size_t r0 = divergence.block * blockSize;
+                divergence.rows.assign(columns.size(), std::vector<double>());
+                for (size_t c = 0; c < columns.size(); c++)
+                    for (size_t r = r0; r < std::min(columns[c].size(), r0 + blockSize); r++)
+                        divergence.rows[c].push_back(columns[c][r]);
+            }
+            if (divergence.found) {
+                divergence.cycle = d.cycle;
+                divergence.table = d.table;
+                return;
+            }
+        }
+    }
+
+    const TraceDivergence &getDivergence() const { return divergence; }
+    bool diverged() const { return divergence.found; }
+    uint64_t getCompared() const { return compared; }
+    size_t getBlockSize() const { return blockSize; }
+
+    // True if the replayed run also consumed the whole trace.
+    bool atEnd() {
+        if (recording)
+            return true;
+        in.peek();
+        return in.eof();
+    }
+};
+
+// Captures the rows of one block of one table at one cycle (for locating a divergence
+// in a rerun of the reference).
+class BlockCapture : public CycleObserver {
+private:
+    uint32_t cycle;
+    uint32_t table;
+    size_t first;
+    size_t count;
+
+public:
+    std::vector<std::vector<double>> rows;
+    bool captured = false;
+
+    BlockCapture(uint32_t cycle_, uint32_t table_, size_t block, size_t blockSize)
+        : cycle(cycle_), table(table_), first(block * blockSize), count(blockSize) {}
+
+    virtual void observe(const World &world, CyclePhase phase) override {
+        if (captured || static_cast<uint32_t>(world.getCurrentCycle()) != cycle
+            || traceTables()[table].phase != phase)
+            return;
+        std::vector<std::vector<double>> columns;
+        captureTable(world, table, columns);
+        rows.assign(columns.size(), std::vector<double>());
+        for (size_t c = 0; c < columns.size(); c++)
+            for (size_t r = first; r < std::min(columns[c].size(), first + count); r++)
+                rows[c].push_back(columns[c][r]);
+        captured = true;
+    }
+};
+
+#endif // GOLDENTRACE_H
@@ -0,0 +1,238 @@
+#ifndef MEANFIELD_H
+#define MEANFIELD_H
+
+#include <vector>
+#include <deque>
+#include <cmath>
+#include <algorithm>
+#include "MemoryAccounting.h"
+
+// Mean-field fast-forward.
+//
+// While the village is quasi-stationary, the agent model is replaced by an aggregate
+// update of its macro state. MeanField watches the last `window` agent cycles of
+// population, unemployment, clearing fish price and GDP per capita. When none of them
+// shows a significant trend, the stretch is calibrated:
+//   - population follows its fitted exponential growth rate,
+//   - unemployment, fish price and GDP per capita are held at their window means.
+// Each series also gets an error bound: z * (residual sd + slope standard error * k)
+// after k aggregate days, plus the neglected trend for the held series. The stretch
+// ends when a bound passes the tolerated relative error, at maxStretch days, or at a
+// scheduled shock; the agent model is then rematerialised from the aggregates.
+
+// One observed (or extrapolated) day of macro state.
+struct MacroState {
+    double population;
+    double unemployment;   // Percent
+    double fishPrice;
+    double gdpPerCapita;
+};
+
+// Counters and worst error bounds of a hybrid run.
+struct MeanFieldReport {
+    int agentCycles = 0;        // Days simulated agent by agent
+    int aggregateCycles = 0;    // Days advanced by the mean-field update
+    int stretches = 0;          // Number of fast-forwarded stretches
+    double populationBound = 0.0;   // Largest relative bound reached at a re-entry
+    double unemploymentBound = 0.0; // Largest bound reached, in percentage points
+    double priceBound = 0.0;        // Largest relative bound reached at a re-entry
+};
+
+// Accuracy of a hybrid run against a full agent run of the same length.
+struct MeanFieldError {
+    double maxPopulation = 0.0;    // Largest relative population difference
+    double meanPopulation = 0.0;   // Mean relative population difference
+    double maxUnemployment = 0.0;  // Largest difference in percentage points
+    double meanUnemployment = 0.0;
+    double maxPrice = 0.0;         // Largest relative fish price difference
+    double meanPrice = 0.0;
+};
+
+class MeanField {
+private:
+    // Least-squares line through a series: slope, its standard error, the residual sd and the mean.
+    struct Fit {
+        double slope = 0.0;
+        double slopeError = 0.0;
+        double residual = 0.0;
+        double mean = 0.0;
+    };
+
+    static Fit fitLine(const std::deque<double> &y) {
+        Fit f;
+        size_t n = y.size();
+        if (n < 3)
+            return f;
+        double tMean = 0.5 * static_cast<double>(n - 1);
+        for (double v : y)
+            f.mean += v;
+        f.mean /= static_cast<double>(n);
+        double stt = 0.0, sty = 0.0;
+        for (size_t t = 0; t < n; t++) {
+            double dt = static_cast<double>(t) - tMean;
+            stt += dt * dt;
+            sty += dt * (y[t] - f.mean);
+        }
+        f.slope = sty / stt;
+        double sse = 0.0;
+        for (size_t t = 0; t < n; t++) {
+            double r = y[t] - f.mean - f.slope * (static_cast<double>(t) - tMean);
+            sse += r * r;
+        }
+        f.residual = std::sqrt(sse / static_cast<double>(n - 2));
+        f.slopeError = f.residual / std::sqrt(stt);
+        return f;
+    }
+
+    int window;           // Agent cycles observed before a stretch may start
+    double tolerance;     // Relative error (and trend) tolerated during a stretch
+    int maxStretch;       // Longest stretch between two re-entries
+    static constexpr double z = 2.0;  // Width of the error bounds in standard deviations
+
+    std::deque<double> logPopulation, unemployment, price, gdpPerCapita;
+
+    // Calibration of the current stretch
+    Fit popFit, unempFit, priceFit, gdpFit;
+    MacroState start;     // Last agent state before the stretch
+    int elapsed;          // Aggregate days advanced in the current stretch
+
+    MeanFieldReport report;
+
+    // Relative scale of a series, guarded against zero levels.
+    static double scale(double level) { return std::max(std::fabs(level), 1e-9); }
+
+    // A trend is insignificant if it is within noise or within tolerance over the window.
+    bool flat(const Fit &f, double level) const {
+        double drift = std::fabs(f.slope) * window;
+        return drift <= z * f.slopeError * window || drift <= tolerance * scale(level);
+    }
+
+public:
+    MeanField(int window_, double tolerance_, int maxStretch_)
+        : window(window_), tolerance(tolerance_), maxStretch(maxStretch_), elapsed(0) {}
+
+    bool enabled() const { return window > 0; }
+
+    // Record one agent cycle.
+    void observe(const MacroState &s) {
+        if (!enabled())
+            return;
+        logPopulation.push_back(std::log(std::max(s.population, 1.0)));
+        unemployment.push_back(s.unemployment);
+        price.push_back(s.fishPrice);
+        gdpPerCapita.push_back(s.gdpPerCapita);
+        if (static_cast<int>(price.size()) > window) {
+            logPopulation.pop_front();
+            unemployment.pop_front();
+            price.pop_front();
+            gdpPerCapita.pop_front();
+        }
+        start = s;
+        report.agentCycles++;
+    }
+
+    // True if a full window has been observed and the unemployment and price
+    // series show no trend; the population trend is extrapolated, not held.
+    bool stationary() const {
+        if (!enabled() || static_cast<int>(price.size()) < window)
+            return false;
+        Fit u = fitLine(unemployment);
+        Fit p = fitLine(price);
+        Fit n = fitLine(logPopulation);
+        if (!flat(u, std::max(u.mean, 1.0)) || !flat(p, p.mean))
+            return false;
+        // The population growth must be steady: the fitted rate is well determined.
+        return n.slopeError * window <= tolerance;
+    }
+
+    // Calibrate a stretch from the current window.
+    void begin() {
+        popFit = fitLine(logPopulation);
+        unempFit = fitLine(unemployment);
+        priceFit = fitLine(price);
+        gdpFit = fitLine(gdpPerCapita);
+        elapsed = 0;
+        report.stretches++;
+    }
+
+    // Relative population bound after k aggregate days (log scale ~ relative).
+    double populationBound(int k) const {
+        return z * (popFit.residual + popFit.slopeError * k);
+    }
+    // Unemployment bound after k days, in percentage points.
+    double unemploymentBound(int k) const {
+        return z * (unempFit.residual + unempFit.slopeError * k) + std::fabs(unempFit.slope) * k;
+    }
+    // Relative fish price bound after k days.
+    double priceBound(int k) const {
+        return (z * (priceFit.residual + priceFit.slopeError * k) + std::fabs(priceFit.slope) * k)
+               / scale(priceFit.mean);
+    }
+
+    // True while the stretch may continue for another day.
+    bool canAdvance() const {
+        int k = elapsed + 1;
+        return k <= maxStretch
+            && populationBound(k) <= tolerance
+            && priceBound(k) <= tolerance
+            && unemploymentBound(k) <= tolerance * 100.0;
+    }
+
+    // Advance the macro state by one day.
+    MacroState advance() {
+        elapsed++;
+        MacroState s;
+        s.population = start.population * std::exp(popFit.slope * elapsed);
+        s.unemployment = unempFit.mean;
+        s.fishPrice = priceFit.mean;
+        s.gdpPerCapita = gdpFit.mean;
+        report.aggregateCycles++;
+        return s;
+    }
+
+    // Close the stretch; a new window must be observed before the next one.
+    void end() {
+        report.populationBound = std::max(report.populationBound, populationBound(elapsed));
+        report.unemploymentBound = std::max(report.unemploymentBound, unemploymentBound(elapsed));
+        report.priceBound = std::max(report.priceBound, priceBound(elapsed));
+        logPopulation.clear();
+        unemployment.clear();
+        price.clear();
+        gdpPerCapita.clear();
+    }
+
+    int getElapsed() const { return elapsed; }
+    const MeanFieldReport &getReport() const { return report; }
+
+    // Compare a hybrid run with a full agent run, day by day.
+    static MeanFieldError compare(const MetricSeries<int> &fullPopulation,
+                                  const MetricSeries<double> &fullUnemployment,
+                                  const MetricSeries<double> &fullPrice,
+                                  const MetricSeries<int> &population,
+                                  const MetricSeries<double> &unemploymentRates,
+                                  const MetricSeries<double> &prices) {
+        MeanFieldError e;
+        size_t n = std::min({fullPopulation.size(), population.size(),
+                             fullUnemployment.size(), unemploymentRates.size(),
+                             fullPrice.size(), prices.size()});
+        if (n == 0)
+            return e;
+        for (size_t i = 0; i < n; i++) {
+            double dp = std::fabs(population[i] - fullPopulation[i]) / scale(fullPopulation[i]);
+            double du = std::fabs(unemploymentRates[i] - fullUnemployment[i]);
+            double dq = std::fabs(prices[i] - fullPrice[i]) / scale(fullPrice[i]);
+            e.maxPopulation = std::max(e.maxPopulation, dp);
+            e.maxUnemployment = std::max(e.maxUnemployment, du);
+            e.maxPrice = std::max(e.maxPrice, dq);
+            e.meanPopulation += dp;
+            e.meanUnemployment += du;
+            e.meanPrice += dq;
+        }
+        e.meanPopulation /= static_cast<double>(n);
+        e.meanUnemployment /= static_cast<double>(n);
+        e.meanPrice /= static_cast<double>(n);
+        return e;
+    }
+};
+
+#endif // MEANFIELD_H
@@ -0,0 +1,29 @@
+#ifndef MODELPOLICY_H
+#define MODELPOLICY_H
+
+// Compile-time model policies.
+//
+// A policy fixes, for a whole build of the simulation, choices that the runtime model
+// reads from its data on every order and application. BasicWorld, BasicSimulation and
+// the market kernels take the policy as a template argument and test its flags with
+// `if constexpr`, so a fixed choice costs nothing in the hot loops: the sector string
+// comparisons, the per-order quantity checks and the skill sort are not compiled in.
+// A policy only states what the village already does; results are the same as with
+// RuntimeModel whenever the data satisfy it.
+
+// Every choice read at run time (the default build: World, Simulation).
+struct RuntimeModel {
+    static constexpr bool singleSector = false;   // Orders, offerings and jobs may name any sector
+    static constexpr bool unitOrders = false;     // A fish order may ask for any quantity
+    static constexpr bool uniformSkills = false;  // Education, experience and preference vary
+};
+
+// The village as it is built: every agent works and shops in the "fishing" sector,
+// each fisherman orders one fish a day, and every skill, requirement and preference is 1.
+struct VillageModel {
+    static constexpr bool singleSector = true;
+    static constexpr bool unitOrders = true;
+    static constexpr bool uniformSkills = true;
+};
+
+#endif
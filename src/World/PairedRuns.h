@@ -0,0 +1,158 @@
+#ifndef PAIREDRUNS_H
+#define PAIREDRUNS_H
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "Simulation.h"
+
+// Paired comparison of two parameter sets (a policy and its alternative).
+//
+// Replicate r runs both sets with seed + r, and each run is summarised by a few
+// run-level metrics. The statistics are computed on the paired differences
+// d_r = B_r - A_r: with common random numbers (see RandomStreams.h) the two runs of a
+// pair share their draws, A_r and B_r are strongly correlated, and var(d) is far
+// below var(A) + var(B), the variance of the difference of independent runs. The
+// report gives, for each metric, the mean difference with its 95% confidence
+// interval, the variance reduction (var(A) + var(B)) / var(d), and the number of
+// replicates needed for the interval to exclude zero at the observed difference,
+// paired and independent.
+
+// Run-level metrics of a paired comparison.
+inline const std::vector<std::string> &pairedMetrics() {
+    static const std::vector<std::string> names = {"DailyGDP", "GDPperCapita", "Unemployment",
+                                                   "FishPrice", "FinalPopulation"};
+    return names;
+}
+
+// Run a simulation to the end (no output files) and summarise it: the mean of each
+// daily series and the final population.
+inline std::vector<double> summarizeRun(const SimulationParameters &p) {
+    Simulation sim(p);
+    while (!sim.finished())
+        sim.advance();
+    auto mean = [](const MetricSeries<double> &x) {
+        double sum = 0.0;
+        for (double v : x)
+            sum += v;
+        return x.empty() ? 0.0 : sum / static_cast<double>(x.size());
+    };
+    const auto &population = sim.getPopulations();
+    return {mean(sim.getGDPs()), mean(sim.getGDPperCapitas()), mean(sim.getUnemploymentRates()),
+            mean(sim.getFishPrices()), population.empty() ? 0.0 : static_cast<double>(population.back())};
+}
+
+struct PairedStatistic {
+    std::string metric;
+    double meanA;
+    double meanB;
+    double meanDiff;           // Mean of B - A
+    double sdDiff;
+    double ciLow;              // 95% confidence interval of the mean difference
+    double ciHigh;
+    double correlation;        // Between A and B across replicates
+    double varianceReduction;  // (var(A) + var(B)) / var(B - A)
+    double pairedReplicates;   // Replicates for the interval to exclude 0 (paired)
+    double unpairedReplicates; // Same with independent runs
+};
+
+struct PairedReport {
+    std::vector<std::vector<double>> a;   // Per replicate, per metric
+    std::vector<std::vector<double>> b;
+    std::vector<PairedStatistic> statistics;
+};
+
+// Run `replicates` pairs on `threads` worker threads (each takes the next run). Runs
+// without common random numbers draw from the process-wide rand(), so they run one
+// at a time.
+inline PairedReport comparePaired(const SimulationParameters &policyA, const SimulationParameters &policyB,
+                                  int replicates, int threads) {
+    PairedReport report;
+    const size_t n = static_cast<size_t>(std::max(replicates, 1));
+    const size_t m = pairedMetrics().size();
+    report.a.assign(n, std::vector<double>());
+    report.b.assign(n, std::vector<double>());
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t job = next++; job < 2 * n; job = next++) {
+            size_t r = job / 2;
+            SimulationParameters p = (job % 2 == 0) ? policyA : policyB;
+            p.seed = policyA.seed + static_cast<unsigned int>(r);
+            (job % 2 == 0 ? report.a : report.b)[r] = summarizeRun(p);
+        }
+    };
+    if (!policyA.commonRandomNumbers || !policyB.commonRandomNumbers)
+        threads = 1;
+    size_t workers = std::min(static_cast<size_t>(std::max(threads, 1)), 2 * n);
+    std::vector<std::thread> pool;
+    for (size_t w = 1; w < workers; w++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+
+    const double z = 1.959963984540054;
+    const double inf = std::numeric_limits<double>::infinity();
+    const double count = static_cast<double>(n);
+    for (size_t k = 0; k < m; k++) {
+        double ma = 0.0, mb = 0.0;
+        for (size_t r = 0; r < n; r++) {
+            ma += report.a[r][k];
+            mb += report.b[r][k];
+        }
+        ma /= count;
+        mb /= count;
+        double va = 0.0, vb = 0.0, cab = 0.0;
+        for (size_t r = 0; r < n; r++) {
+            double da = report.a[r][k] - ma, db = report.b[r][k] - mb;
+            va += da * da;
+            vb += db * db;
+            cab += da * db;
+        }
+        double dof = n > 1 ? count - 1.0 : 1.0;
+        va /= dof;
+        vb /= dof;
+        cab /= dof;
+        double vd = std::max(va + vb - 2.0 * cab, 0.0);
+        PairedStatistic s;
+        s.metric = pairedMetrics()[k];
+        s.meanA = ma;
+        s.meanB = mb;
+        s.meanDiff = mb - ma;
+        s.sdDiff = std::sqrt(vd);
+        double half = z * s.sdDiff / std::sqrt(count);
+        s.ciLow = s.meanDiff - half;
+        s.ciHigh = s.meanDiff + half;
+        s.correlation = (va > 0.0 && vb > 0.0) ? cab / std::sqrt(va * vb) : 0.0;
+        s.varianceReduction = vd > 0.0 ? (va + vb) / vd : inf;
+        double d2 = s.meanDiff * s.meanDiff;
+        s.pairedReplicates = d2 > 0.0 ? std::ceil(z * z * vd / d2) : inf;
+        s.unpairedReplicates = d2 > 0.0 ? std::ceil(z * z * (va + vb) / d2) : inf;
+        report.statistics.push_back(s);
+    }
+    return report;
+}
+
+inline bool writePairedReport(const PairedReport &report, const std::string &path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Unable to open file for writing the paired comparison " << path << "\n";
+        return false;
+    }
+    out << "Metric,MeanA,MeanB,MeanDiff,SdDiff,CI95Low,CI95High,Correlation,VarianceReduction,"
+        << "PairedReplicates,UnpairedReplicates\n";
+    for (const auto &s : report.statistics) {
+        out << s.metric << "," << s.meanA << "," << s.meanB << "," << s.meanDiff << "," << s.sdDiff << ","
+            << s.ciLow << "," << s.ciHigh << "," << s.correlation << "," << s.varianceReduction << ","
+            << s.pairedReplicates << "," << s.unpairedReplicates << "\n";
+    }
+    return true;
+}
+
+#endif // PAIREDRUNS_H
@@ -0,0 +1,252 @@
+#ifndef POPULATION_H
+#define POPULATION_H
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FisherMan.h"
+#include "MemoryAccounting.h"
+#include "Executor.h"
+
+// Description of the initial population to generate.
+struct PopulationSpec {
+    int count = 0;                 // Number of fishermen
+    int employed = 0;              // The first `employed` fishermen start with a job
+    int firms = 1;                 // Number of firms the employed are spread over
+    double ageMean = 30.0;         // Initial age ~ N(ageMean, ageSd) years, clamped at 0
+    double ageSd = 20.0;
+    double lifetimeMean = 60.0;    // Lifetime ~ N(lifetimeMean, lifetimeSd) years
+    double lifetimeSd = 5.0;
+    double daysPerYear = 365.0;
+    unsigned int seed = 1;
+    int threads = 0;               // 0 = hardware concurrency
+};
+
+// One fisherman of a synthetic population, as stored in a population file.
+struct PopulationRecord {
+    int32_t id;
+    int32_t age;          // Days
+    int32_t lifetime;     // Days
+    int32_t employer;     // Index of the employing firm, -1 when unemployed
+    int32_t educationLevel;
+    int32_t experienceLevel;
+    int32_t jobPreference;
+    int32_t reserved;
+    double funds;
+};
+
+// Contiguous storage for the initial fishermen: one allocation for the whole
+// population instead of one make_shared per agent. Fishermen are handed out as
+// aliasing shared_ptrs that keep the arena alive.
+class FisherArena {
+private:
+    FisherMan *data;
+    size_t count;
+    size_t capacity;
+
+public:
+    explicit FisherArena(size_t n)
+        : data(static_cast<FisherMan*>(::operator new(n * sizeof(FisherMan)))), count(0), capacity(n) {
+        MemoryAccounting::allocated(MemoryTag::Fishers, capacity * sizeof(FisherMan));
+    }
+
+    ~FisherArena() {
+        for (size_t i = 0; i < count; i++)
+            data[i].~FisherMan();
+        ::operator delete(data);
+        MemoryAccounting::released(MemoryTag::Fishers, capacity * sizeof(FisherMan));
+    }
+
+    FisherArena(const FisherArena &) = delete;
+    FisherArena &operator=(const FisherArena &) = delete;
+
+    FisherMan *slot(size_t i) { return data + i; }
+    void setConstructed(size_t n) { count = n; }
+};
+
+// Population bootstrap: generates (or loads) the initial population in parallel
+// straight into pre-sized storage.
+class PopulationBootstrap {
+public:
+    static constexpr char magic[8] = {'F', 'V', 'P', 'O', 'P', '0', '1', '\0'};
+    static constexpr uint32_t fileVersion = 2;
+    static constexpr size_t chunkSize = 65536;  // Agents per RNG stream
+
+    // The spec the records were drawn from (all of it but the thread count, which
+    // does not change the draws), so a file is only reused for the same population.
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t count;
+        uint64_t seed;
+        int64_t employed;
+        int64_t firms;
+        double ageMean;
+        double ageSd;
+        double lifetimeMean;
+        double lifetimeSd;
+        double daysPerYear;
+    };
+
+    // True if the file's records were drawn from this spec.
+    static bool matches(const FileHeader &h, const PopulationSpec &spec) {
+        return h.count == static_cast<uint64_t>(std::max(spec.count, 0)) && h.seed == spec.seed &&
+               h.employed == spec.employed && h.firms == spec.firms &&
+               h.ageMean == spec.ageMean && h.ageSd == spec.ageSd &&
+               h.lifetimeMean == spec.lifetimeMean && h.lifetimeSd == spec.lifetimeSd &&
+               h.daysPerYear == spec.daysPerYear;
+    }
+
+    // Draw the population. Every chunk of chunkSize agents has its own generator
+    // seeded from (seed, chunk), so the result does not depend on the thread count.
+    static std::vector<PopulationRecord> generate(const PopulationSpec &spec) {
+        std::vector<PopulationRecord> records(static_cast<size_t>(std::max(spec.count, 0)));
+        int perFirm = spec.firms > 0 ? spec.employed / spec.firms : 0;
+        size_t chunks = (records.size() + chunkSize - 1) / chunkSize;
+        parallelFor(chunks, spec.threads, [&](size_t c) {
+            std::seed_seq seq{spec.seed, static_cast<unsigned int>(c)};
+            std::default_random_engine generator(seq);
+            std::normal_distribution<double> ageDist(spec.ageMean, spec.ageSd);
+            std::normal_distribution<double> lifetimeDist(spec.lifetimeMean, spec.lifetimeSd);
+            size_t end = std::min(records.size(), (c + 1) * chunkSize);
+            for (size_t i = c * chunkSize; i < end; i++) {
+                PopulationRecord &r = records[i];
+                int id = static_cast<int>(i);
+                r.id = id;
+                r.age = static_cast<int32_t>(std::max(0.0, ageDist(generator) * spec.daysPerYear));
+                r.lifetime = static_cast<int32_t>(lifetimeDist(generator) * spec.daysPerYear);
+                if (id < spec.employed && spec.firms > 0) {
+                    // initialEmployed / firms workers per firm, the remainder round-robin.
+                    r.employer = (perFirm > 0 && id < perFirm * spec.firms) ? id / perFirm : id % spec.firms;
+                } else {
+                    r.employer = -1;
+                }
+                r.educationLevel = 1;
+                r.experienceLevel = 1;
+                r.jobPreference = 1;
+                r.reserved = 0;
+                r.funds = 0.0;
+            }
+        });
+        return records;
+    }
+
+    // Construct the fishermen of `records` in a single arena, in parallel.
+    static std::vector<std::shared_ptr<FisherMan>> materialize(const PopulationRecord *records, size_t n,
+                                                               int threads) {
+        auto arena = std::make_shared<FisherArena>(n);
+        std::vector<std::shared_ptr<FisherMan>> fishers(n);
+        size_t chunks = (n + chunkSize - 1) / chunkSize;
+        parallelFor(chunks, threads, [&](size_t c) {
+            size_t end = std::min(n, (c + 1) * chunkSize);
+            for (size_t i = c * chunkSize; i < end; i++) {
+                const PopulationRecord &r = records[i];
+                FisherMan *f = new (arena->slot(i)) FisherMan(
+                    r.id, r.funds, r.lifetime, 0.0, 0.0, 1.0, 1.0, false,
+                    0.0, 0.0, "fishing", r.educationLevel, r.experienceLevel, r.jobPreference);
+                f->setAge(r.age);
+            }
+        });
+        arena->setConstructed(n);
+        for (size_t i = 0; i < n; i++)
+            fishers[i] = std::shared_ptr<FisherMan>(arena, arena->slot(i));
+        return fishers;
+    }
+
+    // Save a synthetic population file (header followed by the raw records).
+    static bool save(const std::string &path, const std::vector<PopulationRecord> &records,
+                     const PopulationSpec &spec) {
+        std::ofstream out(path, std::ios::binary);
+        if (!out.is_open()) {
+            std::cerr << "Error: Unable to write population file " << path << "\n";
+            return false;
+        }
+        FileHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = fileVersion;
+        h.recordSize = sizeof(PopulationRecord);
+        h.count = records.size();
+        h.seed = spec.seed;
+        h.employed = spec.employed;
+        h.firms = spec.firms;
+        h.ageMean = spec.ageMean;
+        h.ageSd = spec.ageSd;
+        h.lifetimeMean = spec.lifetimeMean;
+        h.lifetimeSd = spec.lifetimeSd;
+        h.daysPerYear = spec.daysPerYear;
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(PopulationRecord)));
+        return out.good();
+    }
+
+    // Read-only memory mapping of a population file.
+    class MappedFile {
+    private:
+        void *base = MAP_FAILED;
+        size_t length = 0;
+
+    public:
+        explicit MappedFile(const std::string &path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(FileHeader)) {
+                length = static_cast<size_t>(st.st_size);
+                base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            ::close(fd);
+        }
+        ~MappedFile() {
+            if (base != MAP_FAILED)
+                ::munmap(base, length);
+        }
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        // Header of a valid file, nullptr otherwise.
+        const FileHeader *header() const {
+            if (base == MAP_FAILED)
+                return nullptr;
+            const FileHeader *h = static_cast<const FileHeader*>(base);
+            if (std::memcmp(h->magic, magic, sizeof(magic)) != 0 || h->version != fileVersion ||
+                h->recordSize != sizeof(PopulationRecord) ||
+                length < sizeof(FileHeader) + h->count * sizeof(PopulationRecord))
+                return nullptr;
+            return h;
+        }
+        const PopulationRecord *records() const {
+            return reinterpret_cast<const PopulationRecord*>(static_cast<const char*>(base) + sizeof(FileHeader));
+        }
+    };
+
+    // Run body(0..n-1) over up to `threads` threads (0 = hardware concurrency). This runs
+    // once, before the village exists, so the threads are started for the call.
+    template <class Body>
+    static void parallelFor(size_t n, int threads, Body body) {
+        size_t workers = threads > 0 ? static_cast<size_t>(threads)
+                                     : std::max(1u, std::thread::hardware_concurrency());
+        workers = std::min(workers, n);
+        runChunks(nullptr, workers, [&](size_t w) {
+            for (size_t i = w; i < n; i += workers)
+                body(i);
+        });
+    }
+};
+
+#endif // POPULATION_H
@@ -0,0 +1,231 @@
+#ifndef PRODUCTIONNETWORK_H
+#define PRODUCTIONNETWORK_H
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+#include "Firm.h"
+#include "CapitalFirm.h"
+#include "TaskAccess.h"
+#include "Executor.h"
+
+// Sparse input-output network between the fishing firms (buyers) and the
+// capital-goods firms (suppliers).
+//
+// Row i of the requirement matrix A, stored in CSR, splits one unit of firm i's
+// investment budget across its suppliers: half on boats and half on nets, shared
+// evenly among the suppliers of each good (rows sum to 1). The transpose is kept
+// alongside, so each kernel is a row-parallel gather without atomics:
+//   orders     o = A^T d                     money ordered from each supplier
+//   fill       f_j = min(1, inventory_j price_j / o_j)
+//   spent      s_i = d_i (A f)_i             value delivered to each buyer
+//   fish       k_i = d_i (A (f yield / price))_i
+// A daily clearing therefore costs O(nnz) whatever the number of firm pairs, and
+// memory is O(buyers * suppliersPerFirm). Rows are only appended (a removed firm
+// keeps an empty row), and the transpose is rebuilt after rows were added.
+class ProductionNetwork {
+private:
+    std::vector<std::shared_ptr<CapitalFirm>> suppliers;
+    std::vector<Firm*> buyers;          // Row -> fishing firm (nullptr once removed)
+
+    // A in CSR (rows = buyers, columns = suppliers) and its transpose.
+    std::vector<uint32_t> rowStart;
+    std::vector<uint32_t> column;
+    std::vector<double> weight;
+    std::vector<uint32_t> columnStart;
+    std::vector<uint32_t> row;
+    std::vector<double> weightT;
+    bool transposeStale;
+
+    std::vector<double> demand;         // Investment budget of each buyer today
+    std::vector<double> orders;         // Per supplier
+    std::vector<double> fill;           // Per supplier
+    std::vector<double> fishPerMoney;   // Per supplier: fill * yield / price
+    std::vector<double> revenue;        // Per supplier
+    std::vector<double> spent;          // Per buyer
+    std::vector<double> fish;           // Per buyer
+
+    size_t suppliersPerFirm;
+    int threads;
+    std::default_random_engine generator;
+
+    Executor executor;  // Runs the kernels' ranges (see Executor.h)
+
+    // Run body(begin, end) over [0, n) split into up to `threads` ranges.
+    template <typename Body>
+    void parallelFor(size_t n, const Body &body) const {
+        runRanges(executor, n, std::min<size_t>(static_cast<size_t>(std::max(threads, 1)), n / 4096), body);
+    }
+
+    void transpose() {
+        const size_t m = suppliers.size();
+        columnStart.assign(m + 1, 0);
+        for (uint32_t c : column)
+            columnStart[c + 1]++;
+        for (size_t j = 0; j < m; j++)
+            columnStart[j + 1] += columnStart[j];
+        row.resize(column.size());
+        weightT.resize(column.size());
+        std::vector<uint32_t> next(columnStart.begin(), columnStart.end() - 1);
+        for (size_t i = 0; i + 1 < rowStart.size(); i++) {
+            for (uint32_t k = rowStart[i]; k < rowStart[i + 1]; k++) {
+                uint32_t slot = next[column[k]]++;
+                row[slot] = static_cast<uint32_t>(i);
+                weightT[slot] = weight[k];
+            }
+        }
+        transposeStale = false;
+    }
+
+public:
+    ProductionNetwork(size_t suppliersPerFirm_, unsigned int seed, int threads_ = 1)
+        : rowStart(1, 0),
+          transposeStale(true),
+          suppliersPerFirm(std::max<size_t>(suppliersPerFirm_, 1)),
+          threads(threads_),
+          generator(seed)
+    {}
+
+    void setThreads(int t) { threads = t; }
+    void setExecutor(Executor e) { executor = std::move(e); }
+
+    void addSupplier(std::shared_ptr<CapitalFirm> firm) {
+        suppliers.push_back(firm);
+        transposeStale = true;
+    }
+
+    // Register a fishing firm and draw its suppliers; returns its row.
+    int addBuyer(Firm *firm) {
+        TaskAccess::touch(this, true);
+        int r = static_cast<int>(buyers.size());
+        buyers.push_back(firm);
+        demand.push_back(0.0);
+        if (!suppliers.empty()) {
+            size_t k = std::min(suppliersPerFirm, suppliers.size());
+            std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(suppliers.size() - 1));
+            std::vector<uint32_t> chosen;
+            while (chosen.size() < k) {
+                uint32_t j = pick(generator);
+                if (std::find(chosen.begin(), chosen.end(), j) == chosen.end())
+                    chosen.push_back(j);
+            }
+            std::sort(chosen.begin(), chosen.end());
+            int boats = 0, nets = 0;
+            for (uint32_t j : chosen)
+                (suppliers[j]->getGood() == CapitalGood::Boat ? boats : nets)++;
+            for (uint32_t j : chosen) {
+                bool boat = suppliers[j]->getGood() == CapitalGood::Boat;
+                int same = boat ? boats : nets;
+                // Half of the budget per good, or all of it if only one good is supplied.
+                double share = (boats > 0 && nets > 0) ? 0.5 : 1.0;
+                column.push_back(j);
+                weight.push_back(share / same);
+            }
+        }
+        rowStart.push_back(static_cast<uint32_t>(column.size()));
+        transposeStale = true;
+        return r;
+    }
+
+    void removeBuyer(int r) {
+        TaskAccess::touch(this, true);
+        if (r >= 0 && r < static_cast<int>(buyers.size())) {
+            buyers[r] = nullptr;
+            demand[r] = 0.0;
+        }
+    }
+
+    // A buyer invests a random share of its last profit, as in
+    // Firm::investmentExpenditure but drawn from the network's own generator (or
+    // given as u in [0, 1)).
+    void invest(int r, double profit, double u = -1.0) {
+        TaskAccess::touch(this, true);
+        if (r < 0 || r >= static_cast<int>(buyers.size()) || profit <= 0.0)
+            return;
+        if (u < 0.0) {
+            std::uniform_real_distribution<double> share(0.0, 1.0);
+            u = share(generator);
+        }
+        demand[r] += profit * (1.0 - u);
+    }
+
+    // Produce, match the day's orders against the suppliers' inventories and deliver
+    // the fish equivalent of the capital to the buyers' stock. The money side
+    // (spent per buyer, revenue per supplier) is left to the caller.
+    void clear() {
+        TaskAccess::touch(this, true);
+        if (transposeStale)
+            transpose();
+        const size_t m = suppliers.size();
+        const size_t n = buyers.size();
+        orders.assign(m, 0.0);
+        fill.assign(m, 0.0);
+        fishPerMoney.assign(m, 0.0);
+        revenue.assign(m, 0.0);
+        spent.assign(n, 0.0);
+        fish.assign(n, 0.0);
+        for (auto &s : suppliers) {
+            s->resetSales();
+            s->act();
+        }
+
+        // o = A^T d, then each supplier's fill rate.
+        parallelFor(m, [&](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; j++) {
+                double o = 0.0;
+                for (uint32_t k = columnStart[j]; k < columnStart[j + 1]; k++)
+                    o += weightT[k] * demand[row[k]];
+                orders[j] = o;
+                double price = toDouble(suppliers[j]->getPriceLevel());
+                double available = suppliers[j]->getStock() * price;
+                fill[j] = (o > 0.0) ? std::min(1.0, available / o) : 0.0;
+                fishPerMoney[j] = (price > 0.0) ? fill[j] * suppliers[j]->getFishYield() / price : 0.0;
+            }
+        });
+
+        // Deliveries: s = d * (A f) and k = d * (A (f yield / price)).
+        parallelFor(n, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (demand[i] <= 0.0 || !buyers[i])
+                    continue;
+                double value = 0.0, units = 0.0;
+                for (uint32_t k = rowStart[i]; k < rowStart[i + 1]; k++) {
+                    value += weight[k] * fill[column[k]];
+                    units += weight[k] * fishPerMoney[column[k]];
+                }
+                spent[i] = demand[i] * value;
+                fish[i] = demand[i] * units;
+                buyers[i]->setStock(buyers[i]->getStock() + fish[i]);
+            }
+        });
+
+        for (size_t j = 0; j < m; j++) {
+            double price = toDouble(suppliers[j]->getPriceLevel());
+            if (price <= 0.0)
+                continue;
+            revenue[j] = fill[j] * orders[j];
+            suppliers[j]->sell(revenue[j] / price, orders[j] / price);
+        }
+        std::fill(demand.begin(), demand.end(), 0.0);
+    }
+
+    const std::vector<std::shared_ptr<CapitalFirm>> &getSuppliers() const { return suppliers; }
+    size_t getBuyerCount() const { return buyers.size(); }
+    size_t getLinks() const { return column.size(); }
+
+    // Results of the last clearing.
+    double getSpent(int r) const { return (r >= 0 && r < static_cast<int>(spent.size())) ? spent[r] : 0.0; }
+    double getRevenue(size_t j) const { return j < revenue.size() ? revenue[j] : 0.0; }
+    double getDelivered(int r) const { return (r >= 0 && r < static_cast<int>(fish.size())) ? fish[r] : 0.0; }
+    double getSales() const {
+        TaskAccess::touch(this, false);
+        double total = 0.0;
+        for (double r : revenue)
+            total += r;
+        return total;
+    }
+};
+
+#endif // PRODUCTIONNETWORK_H
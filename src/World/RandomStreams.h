@@ -0,0 +1,85 @@
+#ifndef RANDOMSTREAMS_H
+#define RANDOMSTREAMS_H
+
+#include <cstdint>
+#include <cmath>
+
+// What a keyed draw is used for (part of its key).
+enum class DrawPurpose : uint32_t {
+    Quit = 1,             // Turnover before the fish market
+    Turnover = 2,         // End-of-day turnover
+    Birth = 3,            // Newborns of the day (village-wide)
+    PerceivedPrice = 4,   // Fisherman's perceived fish value
+    OfferedPrice = 5,     // Firm's offered fish price
+    Investment = 6,       // Share of profit kept by a firm
+    PriceAdjustment = 7   // Daily drift of the price means (village-wide)
+};
+
+// Counter-based random streams for common random numbers.
+//
+// A draw is a pure function of (seed, agent, purpose, cycle, index): the key is
+// hashed with the splitmix64 finaliser, so there is no generator state and the
+// draws do not depend on how many draws were made before, by whom, or on which
+// thread. Two runs with the same seed but different parameters therefore give an
+// agent the same draw for the same decision on the same day wherever their states
+// coincide, and their difference has a much smaller variance than that of two
+// independent runs. Village-wide draws use agent 0.
+class RandomStreams {
+private:
+    uint64_t seed;
+
+    static uint64_t mix(uint64_t z) {
+        z += 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+public:
+    explicit RandomStreams(uint64_t seed_ = 0) : seed(seed_) {}
+
+    void setSeed(uint64_t s) { seed = s; }
+    uint64_t getSeed() const { return seed; }
+
+    uint64_t bits(int64_t agent, DrawPurpose purpose, int64_t cycle, uint32_t index = 0) const {
+        uint64_t h = mix(seed ^ mix(static_cast<uint64_t>(agent)));
+        h = mix(h ^ ((static_cast<uint64_t>(purpose) << 32) | index));
+        return mix(h ^ static_cast<uint64_t>(cycle));
+    }
+
+    // Uniform in [0, 1).
+    double uniform(int64_t agent, DrawPurpose purpose, int64_t cycle, uint32_t index = 0) const {
+        return static_cast<double>(bits(agent, purpose, cycle, index) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Standard normal (Box-Muller on draws 2 index and 2 index + 1).
+    double normal(int64_t agent, DrawPurpose purpose, int64_t cycle, uint32_t index = 0) const {
+        double u1 = 1.0 - uniform(agent, purpose, cycle, 2 * index);
+        double u2 = uniform(agent, purpose, cycle, 2 * index + 1);
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+
+    // Poisson by inversion of one uniform, so the count is monotone in lambda: a
+    // larger rate never gives fewer events for the same key.
+    int poisson(double lambda, int64_t agent, DrawPurpose purpose, int64_t cycle) const {
+        if (lambda <= 0.0)
+            return 0;
+        if (lambda > 500.0) {
+            // Normal approximation (exp(-lambda) would underflow).
+            double k = std::floor(lambda + std::sqrt(lambda) * normal(agent, purpose, cycle, 1) + 0.5);
+            return k > 0.0 ? static_cast<int>(k) : 0;
+        }
+        double u = uniform(agent, purpose, cycle);
+        double p = std::exp(-lambda);
+        double cdf = p;
+        int k = 0;
+        while (u > cdf && p > 0.0) {
+            k++;
+            p *= lambda / k;
+            cdf += p;
+        }
+        return k;
+    }
+};
+
+#endif // RANDOMSTREAMS_H
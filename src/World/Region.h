@@ -0,0 +1,200 @@
+#ifndef REGION_H
+#define REGION_H
+
+#ifdef USE_MPI
+
+#include <mpi.h>
+#include <vector>
+#include <memory>
+#include <random>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include "Simulation.h"
+
+// Multi-village regional economy distributed over MPI ranks.
+//
+// Rank r owns villages [r * villagesPerRank, (r + 1) * villagesPerRank), each a full
+// Simulation (World, firms, fishers and markets). After every cycle the villages
+// exchange, in one batch per cycle:
+//  - fish: unsold fish is shipped to villages with unmet demand, pro rata on both
+//    sides, at the region's supply-weighted clearing price (allgather of per-village
+//    surplus, deficit and price, overlapped with packing the migrants);
+//  - people: migrants are bucketed by destination rank and sent with non-blocking
+//    point-to-point messages after an all-to-all of the counts.
+// Regional indicators are reduced onto rank 0, which writes the regional CSV.
+class Region {
+private:
+    // Per-village quantities exchanged every cycle.
+    struct VillageTrade {
+        double unsold;
+        double unmet;
+        double price;
+    };
+
+    MPI_Comm comm;
+    int rank;
+    int ranks;
+    SimulationParameters params;
+    std::vector<std::unique_ptr<Simulation>> villages;
+    std::default_random_engine migrationGenerator;
+    std::ofstream regionFile;
+
+    int totalVillages() const { return ranks * params.villagesPerRank; }
+    int firstVillage() const { return rank * params.villagesPerRank; }
+
+public:
+    Region(const SimulationParameters &p, MPI_Comm c)
+        : comm(c), rank(0), ranks(1), params(p)
+    {
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &ranks);
+        params.villagesPerRank = std::max(1, params.villagesPerRank);
+
+        // Every rank derives its village seeds from the same base seed.
+        unsigned int base = params.seed != 0 ? params.seed : static_cast<unsigned int>(time(0));
+        MPI_Bcast(&base, 1, MPI_UNSIGNED, 0, comm);
+        migrationGenerator.seed(base + 104729u * static_cast<unsigned int>(rank + 1));
+
+        for (int v = 0; v < params.villagesPerRank; v++) {
+            int global = firstVillage() + v;
+            SimulationParameters vp = params;
+            vp.seed = base + 7919u * static_cast<unsigned int>(global + 1);
+            vp.outputPath = pathWithSuffix(params.outputPath, "_village" + std::to_string(global));
+            if (!params.panelPath.empty())
+                vp.panelPath = pathWithSuffix(params.panelPath, "_village" + std::to_string(global));
+            if (!params.telemetryName.empty()) {
+                std::string feed = params.telemetryName == "auto"
+                    ? "/fishingvillage." + std::to_string(::getpid()) : params.telemetryName;
+                vp.telemetryName = feed + ".village" + std::to_string(global);
+            }
+            if (!params.pyramidPath.empty())
+                vp.pyramidPath = pathWithSuffix(params.pyramidPath, "_village" + std::to_string(global));
+            villages.push_back(std::unique_ptr<Simulation>(new Simulation(vp)));
+        }
+    }
+
+    void run() {
+        for (auto &village : villages)
+            village->openOutput();
+        if (rank == 0) {
+            regionFile.open(pathWithSuffix(params.outputPath, "_region"));
+            if (regionFile.is_open())
+                regionFile << "Cycle,Year,DailyGDP,Population,Unemployment,TradedFish,Migrants\n";
+        }
+
+        for (int day = 0; day < params.totalCycles; day++) {
+            // [GDP, population, unemployed]
+            double local[3] = {0.0, 0.0, 0.0};
+            double year = 0.0;
+            for (auto &village : villages) {
+                CycleIndicators ind = village->step();
+                local[0] += ind.dailyGDP;
+                local[1] += ind.population;
+                local[2] += village->getWorld().getUnemployedFishers();
+                year = ind.year;
+            }
+            double exchanged[2] = {0.0, 0.0};  // [traded fish, migrants]
+            exchange(exchanged);
+
+            double sums[5] = {local[0], local[1], local[2], exchanged[0], exchanged[1]};
+            double global[5];
+            MPI_Reduce(sums, global, 5, MPI_DOUBLE, MPI_SUM, 0, comm);
+            if (rank == 0 && regionFile.is_open()) {
+                double unemployment = global[1] > 0 ? global[2] / global[1] * 100.0 : 0.0;
+                regionFile << day + 1 << "," << year << "," << global[0] << ","
+                           << global[1] << "," << unemployment << ","
+                           << global[3] << "," << global[4] << "\n";
+            }
+        }
+
+        for (auto &village : villages)
+            village->closeOutput();
+        if (regionFile.is_open())
+            regionFile.close();
+    }
+
+private:
+    // One batched exchange of fish and migrants. exchanged[0] receives the fish this
+    // rank imported, exchanged[1] the migrants it received.
+    void exchange(double exchanged[2]) {
+        const int nv = params.villagesPerRank;
+
+        // Start the surplus/deficit allgather, then pack migrants while it is in flight.
+        std::vector<VillageTrade> mine(nv), all(static_cast<size_t>(totalVillages()));
+        for (int v = 0; v < nv; v++) {
+            World &world = villages[v]->getWorld();
+            mine[v].unsold = params.tradeSurplus ? world.getUnsoldFish() : 0.0;
+            mine[v].unmet = params.tradeSurplus ? world.getUnmetDemand() : 0.0;
+            mine[v].price = villages[v]->getFishingMarket()->getClearingFishPrice();
+        }
+        MPI_Request tradeRequest;
+        MPI_Iallgather(mine.data(), nv * 3, MPI_DOUBLE,
+                       all.data(), nv * 3, MPI_DOUBLE, comm, &tradeRequest);
+
+        std::vector<std::vector<MigrantRecord>> outbox(ranks);
+        for (int v = 0; v < nv; v++) {
+            auto leaving = villages[v]->getWorld().emigrate(
+                params.migrationRate, firstVillage() + v, totalVillages(), migrationGenerator);
+            for (const auto &m : leaving)
+                outbox[m.destination / nv].push_back(m);
+        }
+
+        // Trade: total volume is min(total surplus, total deficit), shared pro rata.
+        MPI_Wait(&tradeRequest, MPI_STATUS_IGNORE);
+        double supply = 0.0, demand = 0.0, value = 0.0;
+        for (const auto &t : all) {
+            supply += t.unsold;
+            demand += t.unmet;
+            value += t.unsold * t.price;
+        }
+        double volume = std::min(supply, demand);
+        if (volume > 0.0) {
+            money_t price = toMoney(value / supply);
+            for (int v = 0; v < nv; v++) {
+                const VillageTrade &t = mine[v];
+                double imported = volume * t.unmet / demand;
+                double exported = volume * t.unsold / supply;
+                villages[v]->getWorld().shipFish(imported, exported, price);
+                exchanged[0] += imported;
+            }
+        }
+
+        // Migration: exchange counts, then the records themselves, non-blocking.
+        std::vector<int> sendCounts(ranks), recvCounts(ranks);
+        for (int r = 0; r < ranks; r++)
+            sendCounts[r] = static_cast<int>(outbox[r].size());
+        MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm);
+
+        std::vector<std::vector<MigrantRecord>> inbox(ranks);
+        std::vector<MPI_Request> requests;
+        for (int r = 0; r < ranks; r++) {
+            if (recvCounts[r] > 0) {
+                inbox[r].resize(recvCounts[r]);
+                requests.emplace_back();
+                MPI_Irecv(inbox[r].data(), recvCounts[r] * static_cast<int>(sizeof(MigrantRecord)),
+                          MPI_BYTE, r, 0, comm, &requests.back());
+            }
+        }
+        for (int r = 0; r < ranks; r++) {
+            if (sendCounts[r] > 0) {
+                requests.emplace_back();
+                MPI_Isend(outbox[r].data(), sendCounts[r] * static_cast<int>(sizeof(MigrantRecord)),
+                          MPI_BYTE, r, 0, comm, &requests.back());
+            }
+        }
+        MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+
+        // Settle arrivals in source-rank order so the outcome does not depend on timing.
+        for (int r = 0; r < ranks; r++) {
+            for (const auto &m : inbox[r]) {
+                villages[m.destination - firstVillage()]->getWorld().immigrate(m);
+                exchanged[1] += 1.0;
+            }
+        }
+    }
+};
+
+#endif // USE_MPI
+
+#endif // REGION_H
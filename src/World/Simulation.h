@@ -0,0 +1,880 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <random>
+#include <ctime>
+#include <string>
+#include <fstream> // For file output
+#include <algorithm>
+#include <functional>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include "World.h"
+#include "FishingFirm.h"
+#include "FisherMan.h"
+#include "JobMarket.h"
+#include "FishingMarket.h"
+#include "Population.h"
+#include "MeanField.h"
+#include "Panel.h"
+#include "Catalog.h"
+#include "Pyramid.h"
+#include "Telemetry.h"
+
+// "dir/name.csv" -> "dir/name<suffix>.csv"
+inline std::string pathWithSuffix(const std::string &path, const std::string &suffix) {
+    size_t dot = path.rfind('.');
+    size_t slash = path.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return path + suffix;
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+
+// Wealth and price distribution of one cycle, read from the streaming sketches.
+struct DistributionIndicators {
+    double gini = 0.0;         // Gini coefficient of the fishermen's funds
+    double top10Share = 0.0;   // Share of all funds held by the richest 10%
+    double fundsP10 = 0.0;     // Funds quantiles
+    double fundsP50 = 0.0;
+    double fundsP90 = 0.0;
+    double priceP10 = 0.0;     // Transaction price quantiles (weighted by quantity)
+    double priceP90 = 0.0;
+    double priceCV = 0.0;      // Coefficient of variation of the transaction prices
+};
+
+// Indicators of one simulated cycle, as written to the summary CSV.
+struct CycleIndicators {
+    int cycle;
+    double year;
+    double dailyGDP;
+    double cyclyGDP;
+    int population;
+    double gdpPerCapita;
+    double unemployment;   // Percent
+    double inflation;      // Percent
+    double fishPrice;      // Clearing fish price
+    DistributionIndicators distribution;
+};
+
+// Simulation parameters structure
+struct SimulationParameters {
+    // Basic simulation parameters
+    int totalCycles = 300;          // Total simulation cycles (days)
+    int totalFisherMen = 100;       // Total number of fishers
+
+    // Derived parameters (computed as a percentage of totalFisherMen)
+    double totalFirms = 0.08;                 // 8% of the population (at least 1 firm)
+    double initialEmployed = 0.90;            // 90% of the population
+    double totalJobOffers = 0.10;             // 10% of the population
+
+    double initialWage = 5.0;       // Baseline wage / fish price reference
+    double cycleScale = 365;        // Number of days per year
+    int maxStarvingDays = 5;        // Number of consecutive days without fish before death
+    double annualBirthRate = 0.02;  // Annual birth rate (e.g., 2%)
+    double offeredPriceMean = 5.1;  // Mean offered price by firms at start
+    double perceivedPriceMean = 5.0;// Mean perceived price by consumers at start
+    double pQuit = 0.10;            // Daily probability that an employed fisher quits
+    double employeeEfficiency = 2.0; // How many fish a single fisher catches per day
+    double priceFloor = 0.0;        // Minimum price firms may offer (0 = no floor)
+
+    // Execution parameters
+    unsigned int seed = 0;          // Random seed (0 = seed from the clock)
+    int marketThreads = 1;          // Partitions used to clear the fish market (1 = serial)
+    int cycleThreads = 1;           // Threads running the day's task graph (1 = serial; see TaskGraph.h)
+    int sketchK = 200;              // Accuracy of the wealth and price sketches (rank error ~ 1/k)
+    bool commonRandomNumbers = false; // Key the daily draws by agent and purpose (see RandomStreams.h)
+    bool memoryAccounting = false;  // Add per-subsystem memory columns to the CSV (see MemoryAccounting.h)
+    std::string outputPath = "/Users/avass/Documents/1SSE/Code/FishingVillage/data/economicdatas.csv";
+
+    // Banking (see Agent/Bank and docs/Bank.md)
+    bool banking = false;            // Pay wages and fish through a deposit bank's ledger
+    int settlementThreads = 1;       // Chunks of the daily settlement, run on the cycle's threads (0 = one per core)
+    double neutralRate = 0.02;       // Central bank's neutral real rate (annual)
+    double inflationTarget = 0.02;   // Annual inflation target
+    double unemploymentTarget = 0.10;// Unemployment target (fraction)
+    int policyInterval = 30;         // Days between two policy rate decisions
+    double depositSpread = 0.01;     // Deposit rate = policy rate - depositSpread (at least 0)
+    double loanSpread = 0.03;        // Loan rate = policy rate + loanSpread
+    double loanRepayment = 0.10;     // Daily share of min(balance, loan) repaid by borrowers
+
+    // Production network (see ProductionNetwork.h and CapitalFirm.h)
+    int capitalFirms = 0;            // Capital-goods firms, alternately boats and nets (0 = invest straight into stock)
+    int suppliersPerFirm = 3;        // Capital-goods suppliers of each fishing firm
+    double boatPrice = 40.0;         // Initial boat price; a boat adds as many fish to the buyer's stock
+    double netPrice = 8.0;           // Initial net price; a net adds as many fish to the buyer's stock
+    double capitalCapacity = 2.0;    // Units each capital firm produces per day
+    int networkThreads = 1;          // Chunks of the network's sparse kernels, run on the cycle's threads
+
+    // Fishing ground (see FishingGround.h)
+    int groundWidth = 0;             // Cells per row of the fishing ground (0 = no ecological limit)
+    int groundHeight = 64;           // Rows of the fishing ground
+    double carryingCapacity = 100.0; // Fish per cell at saturation
+    double regrowthRate = 0.005;     // Daily logistic regrowth rate
+    double diffusion = 0.1;          // Daily diffusion coefficient (at most 0.25)
+    double catchability = 0.05;      // Largest share of a fishery's biomass caught per day
+    int groundThreads = 1;           // Row bands of the regrowth stencil, run on the cycle's threads
+
+    // Perishable fish (see PerishableStock.h)
+    int shelfLife = 0;               // Days unsold fish keeps (0 = unsold fish is discarded daily)
+    double freshnessDiscount = 0.0;  // Price cut per day of age (0 = one price, sold oldest first)
+
+    // Run catalog (see Catalog.h)
+    std::string catalogPath = "";   // Catalog the run's series are appended to ("" = none)
+
+    // Multi-resolution metric pyramid (see Pyramid.h)
+    std::string pyramidPath = "";   // Pyramid file, viewable during the run ("" = none)
+
+    // Live telemetry (see Telemetry.h)
+    std::string telemetryName = ""; // Shared-memory segment for live indicators ("" = none, "auto" = per process)
+
+    // Agent panel (see Panel.h)
+    std::string panelPath = "";     // Panel snapshot file ("" = no panel)
+    int panelInterval = 30;         // Cycles between two snapshots
+    int panelKeyframe = 16;         // Snapshots between two self-contained keyframes
+
+    // Scenario forking (see Simulation::forkScenarios)
+    int scenarioForkCycle = 0;      // Cycle at which main() forks the example scenarios (0 = never)
+    int scenarioParallel = 0;       // Branches running at once (0 = all)
+
+    // Mean-field fast-forward (see MeanField.h)
+    int meanFieldWindow = 0;         // Agent cycles checked for stationarity (0 = always agent-based)
+    double meanFieldTolerance = 0.05;// Relative error bound tolerated before returning to agents
+    int meanFieldMaxStretch = 365;   // Longest fast-forwarded stretch (days)
+    bool meanFieldValidate = false;  // Also run the full agent model and report speed-up and error
+
+    // Population bootstrap
+    std::string populationFile = "";  // Synthetic population file: loaded if valid, else written
+    int bootstrapThreads = 0;         // Threads generating the population (0 = all cores)
+
+    // Regional (MPI) parameters, used when built with MPI=1
+    int villagesPerRank = 1;        // Villages simulated by each MPI rank
+    double migrationRate = 0.001;   // Daily probability that an unemployed fisher migrates
+    bool tradeSurplus = true;       // Ship unsold fish to villages with unmet demand
+
+
+    // Parameters for population distributions
+    double ageDistMean = 30.0;      // Mean for initial age distribution
+    double ageDistVariance = 20.0;  // Variance for age distribution
+    double lifetimeDistMean = 60.0; // Mean for lifetime distribution
+    double lifetimeDistVariance = 5.0;// Variance for lifetime distribution
+
+    // Constructor computes derived parameters as integer percentages of totalFisherMen
+    SimulationParameters() {
+        totalFirms = static_cast<int>(totalFirms * totalFisherMen);
+        if(totalFirms < 1) totalFirms = 1;
+        initialEmployed = static_cast<int>(initialEmployed * totalFisherMen);
+        totalJobOffers = static_cast<int>(totalJobOffers * totalFisherMen);
+    }
+};
+
+// A scenario branch: a tag naming it and a change applied to the parameters.
+struct ScenarioBranch {
+    std::string tag;
+    std::function<void(SimulationParameters &)> delta;
+};
+
+// Simulation class encapsulating the simulation logic. Model is a compile-time policy
+// (see ModelPolicy.h); Simulation is the runtime-parameter build.
+template <class Model>
+class BasicSimulation {
+private:
+    SimulationParameters params;
+    // Instantiate markets and world
+    std::shared_ptr<JobMarket> jobMarket;
+    std::shared_ptr<FishingMarket> fishingMarket;
+    BasicWorld<Model> world;
+    TrackedVector<std::shared_ptr<FishingFirm>, MemoryTag::Firms> firms;
+
+    // Random number generator
+    std::default_random_engine generator;
+
+    // Normal distributions for firm funds and stock (unused now for stock)
+    std::normal_distribution<double> firmFundsDist; // N(100, 20)
+    // The initial stock is now computed by a rule instead of a random distribution:
+    // std::normal_distribution<double> firmStockDist; // Removed for initial stock
+
+    // Evolving means for offered and perceived prices
+    double currentOfferMean;     // Evolving mean for firm's offered price
+    double currentPerceivedMean; // Evolving mean for consumer's perceived price
+
+    // Distributions for firm offered price and consumer perceived price
+    std::normal_distribution<double> firmPriceDist;    // Initially N(offeredPriceMean, 0.5)
+    std::normal_distribution<double> consumerPriceDist;  // Initially N(perceivedPriceMean, 0.8)
+
+    std::uniform_int_distribution<int> goodsQuantityDist; // Uniform between 1 and 3
+
+    // Run state and metric history
+    int day;                     // Days simulated so far
+    double prevFishPrice;        // Clearing price of the previous day (-1 before the first day)
+    double annualGDPAccumulator;
+    MetricSeries<double> GDPs;
+    MetricSeries<double> unemploymentRates;
+    MetricSeries<double> inflations;
+    MetricSeries<double> gdpPerCapitas;
+    MetricSeries<int> populations;
+    MetricSeries<double> cyclyGDPs;
+    MetricSeries<double> fishPrices;
+    DistributionIndicators distribution;  // Of the last agent cycle (held during mean-field stretches)
+    std::ofstream summaryFile;
+    std::unique_ptr<PanelWriter> panel;
+    std::unique_ptr<PyramidWriter> pyramid;
+    std::unique_ptr<TelemetryWriter> telemetryFeed;
+    MemoryCycle memoryCycle;     // Allocations of the current cycle (memoryAccounting)
+
+    // Mean-field fast-forward
+    MeanField meanField;
+    std::vector<int> shocks;     // Cycles that must be simulated agent by agent
+
+public:
+    // Constructor: initialize simulation parameters, markets, and distributions
+    BasicSimulation(const SimulationParameters &p)
+        : params(resolveSeed(p)),
+          jobMarket(std::make_shared<JobMarket>(p.initialWage, p.perceivedPriceMean, 1)),
+          fishingMarket(std::make_shared<FishingMarket>(p.perceivedPriceMean)),
+          world(p.totalCycles, p.annualBirthRate, jobMarket, fishingMarket, p.maxStarvingDays),
+          generator(params.seed),
+          firmFundsDist(100.0, 20.0),
+          currentOfferMean(p.offeredPriceMean),
+          currentPerceivedMean(p.perceivedPriceMean),
+          firmPriceDist(p.offeredPriceMean, 0.5),
+          consumerPriceDist(p.perceivedPriceMean, 0.8),
+          goodsQuantityDist(1, 3),
+          day(0),
+          prevFishPrice(-1.0),
+          annualGDPAccumulator(0.0),
+          meanField(p.meanFieldWindow, p.meanFieldTolerance, p.meanFieldMaxStretch)
+    {
+        fishingMarket->setClearingThreads(params.marketThreads);
+        world.setCycleThreads(params.cycleThreads);
+        fishingMarket->setSketchAccuracy(static_cast<size_t>(params.sketchK));
+        world.setSketchAccuracy(static_cast<size_t>(params.sketchK));
+        // Turnover: each employed fisher quits with probability pQuit at the end of each day.
+        world.setQuitProbability(params.pQuit);
+        world.setPriceFloor(params.priceFloor);
+        world.setPerishable(params.shelfLife, params.freshnessDiscount);
+        world.setCommonRandomNumbers(params.commonRandomNumbers, params.seed);
+        if (params.banking) {
+            auto central = std::make_shared<CentralBank>(1, params.neutralRate, params.inflationTarget,
+                params.unemploymentTarget, params.policyInterval, static_cast<int>(params.cycleScale));
+            world.setBanking(std::make_shared<DepositBank>(2, central->getPolicyRate(), params.depositSpread,
+                params.loanSpread, params.loanRepayment, params.settlementThreads), central);
+        }
+        if (params.groundWidth > 0) {
+            world.setFishingGround(std::make_shared<FishingGround>(params.groundWidth, params.groundHeight,
+                params.carryingCapacity, params.regrowthRate, params.diffusion, params.catchability,
+                params.groundThreads));
+        }
+        if (params.capitalFirms > 0) {
+            auto network = std::make_shared<ProductionNetwork>(static_cast<size_t>(params.suppliersPerFirm),
+                static_cast<unsigned int>(generator()), params.networkThreads);
+            int firstID = 100 + static_cast<int>(params.totalFirms);
+            for (int j = 0; j < params.capitalFirms; j++) {
+                CapitalGood good = (j % 2 == 0) ? CapitalGood::Boat : CapitalGood::Net;
+                double price = (good == CapitalGood::Boat) ? params.boatPrice : params.netPrice;
+                network->addSupplier(std::allocate_shared<CapitalFirm>(TrackedAllocator<CapitalFirm, MemoryTag::Firms>(),
+                    firstID + j, 100.0, good, price, params.capitalCapacity, price));
+            }
+            world.setProductionNetwork(network);
+        }
+
+        // Initialize FishingFirms with initialStock computed as population/numberFirms.
+        // Ensuring the stock is an integer.
+        int initialStock = params.totalFisherMen / params.totalFirms;
+        for (int id = 100; id < 100 + params.totalFirms; id++) {
+            double funds = firmFundsDist(generator);
+            int stock = initialStock; // Updated rule: initialStock = population / numberFirms
+            int lifetime = 100000000; // Firm lifetime (days)
+            
+            // Use the parameter for employee efficiency.
+            double salesEff = params.employeeEfficiency;
+            // Employees are attached by the population bootstrap through the World's employer index.
+            auto firm = std::allocate_shared<FishingFirm>(TrackedAllocator<FishingFirm, MemoryTag::Firms>(),
+                                                          id, funds, lifetime, 0, stock, salesEff);
+            double price = firmPriceDist(generator);
+            firm->setPriceLevel(toMoney(price));
+            firms.push_back(firm);
+            world.addFirm(firm);
+        }
+
+        // Initialize the FisherMen through the population bootstrap: either load the
+        // synthetic population file, or draw age and lifetime in parallel (and save the
+        // file if a path was given). The first initialEmployed fishermen are employed,
+        // initialEmployeesPerFirm per firm and the remainder round-robin.
+        bootstrapPopulation();
+    }
+
+    // Parameters with the clock seed filled in, so the run can be reproduced (seed 0 = clock).
+    static SimulationParameters resolveSeed(SimulationParameters p) {
+        if (p.seed == 0)
+            p.seed = static_cast<unsigned int>(time(0));
+        return p;
+    }
+
+    // Load or generate the initial population and attach it to the World.
+    void bootstrapPopulation() {
+        std::vector<PopulationRecord> generated;
+        const PopulationRecord *records = nullptr;
+        size_t count = 0;
+
+        // The population seed is drawn whether or not the file is used, so a run that
+        // loads the population continues with the same draws as the run that saved it.
+        PopulationSpec spec;
+        spec.count = params.totalFisherMen;
+        spec.employed = static_cast<int>(params.initialEmployed);
+        spec.firms = static_cast<int>(params.totalFirms);
+        spec.ageMean = params.ageDistMean;
+        spec.ageSd = params.ageDistVariance;
+        spec.lifetimeMean = params.lifetimeDistMean;
+        spec.lifetimeSd = params.lifetimeDistVariance;
+        spec.daysPerYear = params.cycleScale;
+        spec.seed = static_cast<unsigned int>(generator());
+        spec.threads = params.bootstrapThreads;
+
+        // A file drawn from other parameters is regenerated and overwritten.
+        std::unique_ptr<PopulationBootstrap::MappedFile> mapped;
+        if (!params.populationFile.empty()) {
+            mapped.reset(new PopulationBootstrap::MappedFile(params.populationFile));
+            const auto *header = mapped->header();
+            if (header && PopulationBootstrap::matches(*header, spec)) {
+                records = mapped->records();
+                count = header->count;
+            } else {
+                mapped.reset();
+            }
+        }
+        if (records == nullptr) {
+            generated = PopulationBootstrap::generate(spec);
+            records = generated.data();
+            count = generated.size();
+            if (!params.populationFile.empty())
+                PopulationBootstrap::save(params.populationFile, generated, spec);
+        }
+
+        std::vector<std::shared_ptr<FisherMan>> population =
+            PopulationBootstrap::materialize(records, count, params.bootstrapThreads);
+        world.reserveFishers(count);
+        for (size_t i = 0; i < count; i++) {
+            world.addFisherMan(population[i]);
+            int employer = records[i].employer;
+            if (employer >= 0 && employer < static_cast<int>(firms.size()))
+                world.hire(population[i].get(), firms[employer]->getID(), toMoney(params.initialWage));
+        }
+    }
+
+    // Open the CSV file for writing the simulation summary.
+    bool openOutput() {
+        if (!params.panelPath.empty()) {
+            panel.reset(new PanelWriter(params.panelPath, params.panelInterval, params.panelKeyframe));
+            if (!panel->isOpen())
+                std::cerr << "Error: Unable to open panel file " << params.panelPath << "\n";
+        }
+        if (!params.pyramidPath.empty()) {
+            pyramid.reset(new PyramidWriter(params.pyramidPath,
+                {"DailyGDP", "Population", "GDPperCapita", "Unemployment", "Inflation", "FishPrice", "Gini"},
+                static_cast<uint64_t>(std::max(params.totalCycles, 1))));
+            if (!pyramid->isOpen())
+                std::cerr << "Error: Unable to open pyramid file " << params.pyramidPath << "\n";
+        }
+        if (!params.telemetryName.empty()) {
+            std::string name = params.telemetryName == "auto"
+                ? "/fishingvillage." + std::to_string(::getpid()) : params.telemetryName;
+            telemetryFeed.reset(new TelemetryWriter(name,
+                {"Cycle", "Year", "DailyGDP", "CyclyGDP", "Population", "GDPperCapita", "Unemployment",
+                 "Inflation", "FishPrice", "Gini", "Top10Share", "FundsP50", "PriceCV"}));
+            if (!telemetryFeed->isOpen())
+                std::cerr << "Error: Unable to create telemetry segment " << name << "\n";
+        }
+        summaryFile.open(params.outputPath);
+        if (summaryFile.is_open()) {
+            summaryFile << "Cycle,Year,DailyGDP,CyclyGDP,Population,GDPperCapita,Unemployment,Inflation,"
+                        << "Gini,Top10Share,FundsP10,FundsP50,FundsP90,PriceP10,PriceP90,PriceCV"
+                        << (world.getBank() ? ",PolicyRate,Deposits,Loans" : "")
+                        << (world.getFishingGround() ? ",Biomass" : "")
+                        << (world.getShelfLife() > 0 ? ",Spoiled,HeldFish" : "")
+                        << (params.memoryAccounting ? MemoryCycle::columns() : "") << "\n";
+            memoryCycle.begin();
+            return true;
+        }
+        std::cerr << "Error: Unable to open file for writing summary data.\n";
+        return false;
+    }
+
+    void closeOutput() {
+        if (summaryFile.is_open())
+            summaryFile.close();
+        if (panel)
+            panel->close();
+        if (pyramid)
+            pyramid->close();
+        if (telemetryFeed)
+            telemetryFeed->close();
+        if (!params.catalogPath.empty() && !RunCatalog::append(params.catalogPath, catalogRun(), time(0)))
+            std::cerr << "Error: Unable to append to the run catalog " << params.catalogPath << "\n";
+    }
+
+    // The run as a catalog record: its parameters and daily series.
+    CatalogRun catalogRun() const {
+        CatalogRun run;
+        run.seed = params.seed;
+        run.label = params.outputPath;
+        run.parameters = {
+            {"totalCycles", params.totalCycles},
+            {"totalFisherMen", params.totalFisherMen},
+            {"totalFirms", params.totalFirms},
+            {"initialEmployed", params.initialEmployed},
+            {"totalJobOffers", params.totalJobOffers},
+            {"initialWage", params.initialWage},
+            {"cycleScale", params.cycleScale},
+            {"maxStarvingDays", params.maxStarvingDays},
+            {"annualBirthRate", params.annualBirthRate},
+            {"offeredPriceMean", params.offeredPriceMean},
+            {"perceivedPriceMean", params.perceivedPriceMean},
+            {"pQuit", params.pQuit},
+            {"employeeEfficiency", params.employeeEfficiency},
+            {"priceFloor", params.priceFloor},
+            {"commonRandomNumbers", params.commonRandomNumbers ? 1.0 : 0.0},
+            {"banking", params.banking ? 1.0 : 0.0},
+            {"capitalFirms", params.capitalFirms},
+            {"groundWidth", params.groundWidth},
+            {"groundHeight", params.groundHeight},
+            {"regrowthRate", params.regrowthRate},
+            {"catchability", params.catchability},
+            {"shelfLife", params.shelfLife},
+            {"freshnessDiscount", params.freshnessDiscount},
+            {"seed", static_cast<double>(params.seed)},
+        };
+        std::vector<double> population(populations.begin(), populations.end());
+        std::vector<double> inflation(inflations.size());
+        for (size_t i = 0; i < inflations.size(); i++)
+            inflation[i] = inflations[i] * 100;
+        auto series = [](const MetricSeries<double> &x) { return std::vector<double>(x.begin(), x.end()); };
+        run.columns = {
+            {"DailyGDP", series(GDPs)},
+            {"Population", population},
+            {"GDPperCapita", series(gdpPerCapitas)},
+            {"Unemployment", series(unemploymentRates)},
+            {"Inflation", inflation},
+            {"FishPrice", series(fishPrices)},
+        };
+        return run;
+    }
+
+    // Snapshot every fisherman into the panel (encoded on the writer's thread).
+    void capturePanel(int cycle) {
+        PanelSnapshot snap;
+        snap.cycle = cycle;
+        const auto &fishers = world.getFishers();
+        const EmploymentIndex &employment = world.getEmployment();
+        snap.ids.reserve(fishers.size());
+        for (const auto &fisher : fishers) {
+            int slot = fisher->getEmployerSlot();
+            snap.add(fisher->getID(), toDouble(fisher->getFunds()),
+                     slot >= 0 ? employment.getFirmID(slot) : -1,
+                     fisher->getDaysWithoutEat(), fisher->getAge());
+        }
+        panel->capture(std::move(snap));
+    }
+
+    // Simulate one cycle (day) and return its indicators.
+    CycleIndicators step() {
+#if verbose==1
+        int cycle = day + 1; // Cycle number (starting at 1)
+        double currentYear = cycle / params.cycleScale;  // Convert cycle to years
+        std::cout << "===== Day " << cycle << " (Year " << currentYear << ") =====" << std::endl;
+#endif
+        // Run one simulation cycle.
+        world.simulateCycle(generator, firmPriceDist, goodsQuantityDist, consumerPriceDist);
+        
+        // ---- Job Market Update and Turnover ----
+        double updatedFishPrice = fishingMarket->getClearingFishPrice();
+        jobMarket->setCurrentFishPrice(updatedFishPrice);
+        jobMarket->clear<Model>(generator);  // Recalculate clearing wage
+        
+        // --- JOB POSTING: Limit total job offers to params.totalJobOffers ---
+        // Calculate vacancies per firm (ensuring an integer result):
+        int vacanciesPerFirm = std::max(1, static_cast<int>(params.totalJobOffers / params.totalFirms));
+        // For each firm, generate a job posting with the computed vacancies.
+        for (auto &firm : firms) {
+            JobPosting posting = firm->generateJobPosting("fishing", 1, 1, 1);
+            posting.vacancies = vacanciesPerFirm;
+            jobMarket->submitJobPosting(posting);
+        }
+        
+        // Retrieve current population, GDP, unemployment and fish price.
+        int totalFishers = world.getTotalFishers();
+        double dailyGDP = toDouble(world.getGDP());
+        int unemployedFishers = world.getUnemployedFishers();
+        double dailyUnemploymentRate = (totalFishers > 0) ?
+            (static_cast<double>(unemployedFishers) / totalFishers) * 100.0 : 0.0;
+        if (prevFishPrice < 0.0)
+            prevFishPrice = updatedFishPrice;
+        double currFishPrice = fishingMarket->getClearingFishPrice();
+        
+        // Update evolving price means.
+        double aggSupply = fishingMarket->getAggregateSupply();
+        double aggDemand = fishingMarket->getAggregateDemand();
+        double ratio = (aggSupply > 0) ? aggDemand / aggSupply : 1.0;
+        double factor = 1.0;
+        if (ratio != 1.0 && world.usesCommonRandomNumbers()) {
+            double z = world.getRandomStreams().normal(0, DrawPurpose::PriceAdjustment, day);
+            factor = (ratio > 1.0 ? 1.025 : 0.975) + 0.005 * z;
+        } else if (ratio > 1.0) {
+            std::normal_distribution<double> adjustDist(1.025, 0.005);
+            factor = adjustDist(generator);
+        } else if (ratio < 1.0) {
+            std::normal_distribution<double> adjustDist(0.975, 0.005);
+            factor = adjustDist(generator);
+        }
+        currentOfferMean *= factor;
+        currentPerceivedMean *= factor;
+        firmPriceDist.param(std::normal_distribution<double>::param_type(currentOfferMean, 0.5));
+        consumerPriceDist.param(std::normal_distribution<double>::param_type(currentPerceivedMean, 0.8));
+
+        // Distribution indicators from the sketches filled during the cycle (no sort of the population).
+        const QuantileSketch &funds = world.getFundsSketch();
+        const QuantileSketch &prices = fishingMarket->getPriceSketch();
+        distribution.gini = funds.gini();
+        distribution.top10Share = funds.topShare(0.1);
+        distribution.fundsP10 = funds.quantile(0.1);
+        distribution.fundsP50 = funds.quantile(0.5);
+        distribution.fundsP90 = funds.quantile(0.9);
+        distribution.priceP10 = prices.quantile(0.1);
+        distribution.priceP90 = prices.quantile(0.9);
+        distribution.priceCV = fishingMarket->getPriceDispersion();
+
+        CycleIndicators out = record(dailyGDP, totalFishers, dailyUnemploymentRate, currFishPrice);
+        if (panel && out.cycle % std::max(params.panelInterval, 1) == 0)
+            capturePanel(out.cycle);
+        MacroState state;
+        state.population = totalFishers;
+        state.unemployment = dailyUnemploymentRate;
+        state.fishPrice = currFishPrice;
+        state.gdpPerCapita = out.gdpPerCapita;
+        meanField.observe(state);
+        return out;
+    }
+
+    // Append one day to the history and the summary CSV, and move to the next day.
+    CycleIndicators record(double dailyGDP, int totalFishers, double dailyUnemploymentRate,
+                           double currFishPrice) {
+        int cycle = day + 1;
+        double currentYear = cycle / params.cycleScale;
+        populations.push_back(totalFishers);
+        GDPs.push_back(dailyGDP);
+        annualGDPAccumulator += dailyGDP;
+        
+        double perCapita = (totalFishers > 0) ? dailyGDP / totalFishers : 0.0;
+        gdpPerCapitas.push_back(perCapita);
+        unemploymentRates.push_back(dailyUnemploymentRate);
+        
+        double inflRate = (prevFishPrice > 0) ? (currFishPrice - prevFishPrice) / prevFishPrice : 0.0;
+        inflations.push_back(inflRate);
+        fishPrices.push_back(currFishPrice);
+        prevFishPrice = currFishPrice;
+        
+        double cyclyGDPOutput = 0.0;
+        if (cycle % static_cast<int>(params.cycleScale) == 0 || day == params.totalCycles - 1) {
+            cyclyGDPs.push_back(annualGDPAccumulator);
+            cyclyGDPOutput = annualGDPAccumulator;
+            annualGDPAccumulator = 0.0;
+        }
+        
+        if (summaryFile.is_open()) {
+            summaryFile << cycle << ","
+                        << currentYear << ","
+                        << dailyGDP << ","
+                        << cyclyGDPOutput << ","
+                        << totalFishers << ","
+                        << perCapita << ","
+                        << dailyUnemploymentRate << ","
+                        << inflRate * 100 << ","
+                        << distribution.gini << ","
+                        << distribution.top10Share << ","
+                        << distribution.fundsP10 << ","
+                        << distribution.fundsP50 << ","
+                        << distribution.fundsP90 << ","
+                        << distribution.priceP10 << ","
+                        << distribution.priceP90 << ","
+                        << distribution.priceCV;
+            if (auto bank = world.getBank()) {
+                const SettlementReport &settled = bank->getLastSettlement();
+                summaryFile << "," << world.getCentralBank()->getPolicyRate() * 100
+                            << "," << settled.deposits
+                            << "," << settled.loans;
+            }
+            if (auto ground = world.getFishingGround())
+                summaryFile << "," << ground->getLevel() * 100;
+            if (world.getShelfLife() > 0)
+                summaryFile << "," << world.getLastSpoiled() << "," << world.getHeldCatch();
+            if (params.memoryAccounting)
+                writeMemoryColumns(totalFishers);
+            summaryFile << "\n";
+        }
+        if (pyramid)
+            pyramid->append({dailyGDP, static_cast<double>(totalFishers), perCapita,
+                             dailyUnemploymentRate, inflRate * 100, currFishPrice, distribution.gini});
+        day++;
+
+        CycleIndicators out;
+        out.cycle = cycle;
+        out.year = currentYear;
+        out.dailyGDP = dailyGDP;
+        out.cyclyGDP = cyclyGDPOutput;
+        out.population = totalFishers;
+        out.gdpPerCapita = perCapita;
+        out.unemployment = dailyUnemploymentRate;
+        out.inflation = inflRate * 100;
+        out.fishPrice = currFishPrice;
+        out.distribution = distribution;
+        if (telemetryFeed) {
+            double values[] = {static_cast<double>(cycle), currentYear, dailyGDP, cyclyGDPOutput,
+                               static_cast<double>(totalFishers), perCapita, dailyUnemploymentRate,
+                               inflRate * 100, currFishPrice, distribution.gini,
+                               distribution.top10Share, distribution.fundsP50, distribution.priceCV};
+            telemetryFeed->publish(values, sizeof(values) / sizeof(values[0]));
+        }
+        return out;
+    }
+
+    // Per-subsystem memory of the cycle just recorded, then open the next cycle's window.
+    void writeMemoryColumns(int totalFishers) {
+        std::vector<MemoryUsage> usage = memoryCycle.end();
+        int64_t total = 0;
+        for (const auto &u : usage) {
+            summaryFile << "," << u.bytes << "," << u.peak << "," << u.allocations;
+            total += u.bytes;
+        }
+        size_t agents = static_cast<size_t>(std::max(totalFishers, 0)) + world.getFirms().size();
+        summaryFile << "," << total << "," << (agents > 0 ? static_cast<double>(total) / static_cast<double>(agents) : 0.0)
+                    << "," << MemoryAccounting::peakResidentBytes();
+        memoryCycle.begin();
+    }
+
+    // Force agent-level simulation of the given cycle (e.g. a parameter change), so
+    // no mean-field stretch runs across it.
+    void scheduleShock(int cycle) {
+        shocks.push_back(cycle);
+    }
+
+    // Advance the simulation: one agent cycle, or, in mean-field mode while the
+    // village is stationary, a whole aggregate stretch followed by re-entry.
+    void advance() {
+        if (meanField.stationary()) {
+            int limit = params.totalCycles;
+            for (int shock : shocks)
+                if (shock > day && shock <= limit)
+                    limit = shock - 1;
+            if (limit > day) {
+                fastForward(limit);
+                return;
+            }
+        }
+        step();
+    }
+
+    // Mean-field stretch: aggregate days up to cycle `limit` while the error bounds
+    // hold, then rematerialise the agents from the final aggregate state.
+    void fastForward(int limit) {
+        meanField.begin();
+        MacroState state;
+        bool any = false;
+        while (day < limit && meanField.canAdvance()) {
+            state = meanField.advance();
+            int totalFishers = static_cast<int>(std::lround(state.population));
+            record(state.gdpPerCapita * totalFishers, totalFishers, state.unemployment, state.fishPrice);
+            any = true;
+        }
+        int days = meanField.getElapsed();
+        meanField.end();
+        if (!any)
+            return;
+#if verbose==1
+        std::cout << "Mean-field stretch of " << days << " days ending at day " << day << std::endl;
+#endif
+        int population = static_cast<int>(std::lround(state.population));
+        int unemployed = static_cast<int>(std::lround(state.unemployment / 100.0 * population));
+        money_t wage = toMoney(1.5 * jobMarket->getClearingWage());
+        world.fastForward(days, population, unemployed, wage, generator);
+        world.setPreviousFishPrice(state.fishPrice);
+        jobMarket->setCurrentFishPrice(state.fishPrice);
+    }
+
+    // Run the simulation cycles.
+    void run() {
+        openOutput();
+        // Simulation loop (each cycle represents one day).
+        while (day < params.totalCycles)
+            advance();
+        closeOutput();
+    }
+
+    // Change the parameters of a running simulation. Only the parameters read during
+    // the cycle take effect; population and firm setup parameters (and turning
+    // banking on or off) are ignored.
+    void applyParameters(const SimulationParameters &p) {
+        params = p;
+        world.setAnnualBirthRate(p.annualBirthRate);
+        world.setMaxStarvingDays(p.maxStarvingDays);
+        world.setQuitProbability(p.pQuit);
+        world.setPriceFloor(p.priceFloor);
+        world.setFreshnessDiscount(p.freshnessDiscount);
+        if (auto bank = world.getBank()) {
+            bank->setTerms(p.depositSpread, p.loanSpread, p.loanRepayment, p.settlementThreads);
+            world.getCentralBank()->setTargets(p.neutralRate, p.inflationTarget, p.unemploymentTarget,
+                                               p.policyInterval);
+        }
+        if (auto network = world.getProductionNetwork())
+            network->setThreads(p.networkThreads);
+        if (auto ground = world.getFishingGround()) {
+            ground->setRates(p.regrowthRate, p.diffusion, p.catchability);
+            ground->setThreads(p.groundThreads);
+        }
+        fishingMarket->setClearingThreads(p.marketThreads);
+        world.setCycleThreads(p.cycleThreads);
+        fishingMarket->setSketchAccuracy(static_cast<size_t>(p.sketchK));
+        world.setSketchAccuracy(static_cast<size_t>(p.sketchK));
+        for (auto &firm : firms)
+            firm->setSalesEfficiency(p.employeeEfficiency);
+    }
+
+    // Branch the running simulation into one future per scenario. Each branch is a
+    // fork()ed child process: it starts from a copy-on-write image of this process,
+    // so memory grows only with the pages a branch modifies. The child applies its
+    // parameter delta, runs to totalCycles writing to outputPath tagged with
+    // "_<tag>" (after a copy of the rows up to the fork), and exits. At most maxParallel branches run at once (0 = all).
+    // The parent waits for every branch, writes a "_scenarios" index file, and
+    // returns the number of branches that completed successfully; it can then
+    // continue as the baseline.
+    int forkScenarios(const std::vector<ScenarioBranch> &branches, int maxParallel = 0) {
+        // Nothing buffered may be duplicated into the children, and no thread may be
+        // running when the process forks: stop the cycle's pool and the panel encoder
+        // until the branches are done.
+        if (summaryFile.is_open())
+            summaryFile.flush();
+        if (panel)
+            panel->suspend();
+        world.stopCycleThreads();
+        std::cout.flush();
+        std::cerr.flush();
+
+        size_t limit = maxParallel > 0 ? static_cast<size_t>(maxParallel) : branches.size();
+        std::vector<pid_t> pids(branches.size(), -1);
+        std::vector<int> status(branches.size(), -1);
+        size_t running = 0, next = 0, done = 0, oldest = 0;
+        int succeeded = 0;
+        while (done < branches.size()) {
+            while (running < limit && next < branches.size()) {
+                pid_t pid = ::fork();
+                if (pid == 0)
+                    runBranch(branches[next]);  // never returns
+                if (pid < 0) {
+                    std::cerr << "Error: Unable to fork scenario " << branches[next].tag << "\n";
+                    done++;
+                } else {
+                    pids[next] = pid;
+                    running++;
+                }
+                next++;
+            }
+            if (running == 0)
+                continue;
+            // Wait for the oldest running branch (branches run the same number of days,
+            // so they finish in about the order they started). Only our own children are
+            // reaped, not those of a launcher sharing the process.
+            size_t b = oldest;
+            while (pids[b] < 0)
+                b++;
+            oldest = b + 1;
+            int st = 0;
+            pid_t finishedPid;
+            do {
+                finishedPid = ::waitpid(pids[b], &st, 0);
+            } while (finishedPid < 0 && errno == EINTR);
+            status[b] = (finishedPid == pids[b] && WIFEXITED(st)) ? WEXITSTATUS(st) : -1;
+            if (status[b] == 0)
+                succeeded++;
+            running--;
+            done++;
+        }
+        world.startCycleThreads();
+        if (panel)
+            panel->resume();
+
+        std::ofstream index(pathWithSuffix(params.outputPath, "_scenarios"));
+        if (index.is_open()) {
+            index << "Branch,ForkCycle,Status,Output\n";
+            for (size_t b = 0; b < branches.size(); b++) {
+                index << branches[b].tag << "," << day << "," << status[b] << ","
+                      << pathWithSuffix(params.outputPath, "_" + branches[b].tag) << "\n";
+            }
+        }
+        return succeeded;
+    }
+
+    bool finished() const { return day >= params.totalCycles; }
+    int getDay() const { return day; }
+    const SimulationParameters &getParameters() const { return params; }
+    BasicWorld<Model> &getWorld() { return world; }
+    std::shared_ptr<FishingMarket> getFishingMarket() const { return fishingMarket; }
+    const MeanFieldReport &getMeanFieldReport() const { return meanField.getReport(); }
+    const MetricSeries<int> &getPopulations() const { return populations; }
+    const MetricSeries<double> &getUnemploymentRates() const { return unemploymentRates; }
+    const MetricSeries<double> &getFishPrices() const { return fishPrices; }
+    const MetricSeries<double> &getGDPs() const { return GDPs; }
+    const MetricSeries<double> &getGDPperCapitas() const { return gdpPerCapitas; }
+    const MetricSeries<double> &getInflations() const { return inflations; }
+
+private:
+    // Body of a forked scenario branch (child process).
+    [[noreturn]] void runBranch(const ScenarioBranch &branch) {
+        // The parent's file stays with the parent: drop our copy without writing to it.
+        const std::string parentOutput = summaryFile.is_open() ? params.outputPath : "";
+        summaryFile.close();
+        // The panel and pyramid files and the telemetry segment belong to the parent:
+        // close the copies without writing to them, and start our own cycle threads.
+        if (panel)
+            panel->detach();
+        panel.reset();
+        if (pyramid)
+            pyramid->detach();
+        pyramid.reset();
+        if (telemetryFeed)
+            telemetryFeed->detach();
+        world.startCycleThreads();
+        SimulationParameters p = params;
+        if (branch.delta)
+            branch.delta(p);
+        p.outputPath = pathWithSuffix(params.outputPath, "_" + branch.tag);
+        if (!p.panelPath.empty())
+            p.panelPath = pathWithSuffix(params.panelPath, "_" + branch.tag);
+        if (!p.pyramidPath.empty())
+            p.pyramidPath = pathWithSuffix(params.pyramidPath, "_" + branch.tag);
+        if (!p.telemetryName.empty() && p.telemetryName != "auto")
+            p.telemetryName = params.telemetryName + "." + branch.tag;
+        applyParameters(p);
+        bool ok = openOutput();
+        if (!parentOutput.empty() && summaryFile.is_open()) {
+            // Start with the parent's rows up to the fork (flushed before forking), so
+            // the branch's file covers the whole run.
+            std::ifstream parent(parentOutput);
+            std::string row;
+            std::getline(parent, row);  // Header, already written by openOutput
+            while (std::getline(parent, row))
+                summaryFile << row << "\n";
+        }
+        while (day < params.totalCycles)
+            advance();
+        closeOutput();
+        std::cout.flush();
+        ::_exit(ok ? 0 : 1);
+    }
+};
+
+using Simulation = BasicSimulation<RuntimeModel>;
+
+#endif // SIMULATION_H
@@ -0,0 +1,89 @@
+#ifndef TASKACCESS_H
+#define TASKACCESS_H
+
+#include <iostream>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include <cstdint>
+
+// Access hooks for the race detector of the cycle's task graph (see TaskGraph.h).
+//
+// A task graph binds each shared object of the cycle (the employment index, the
+// markets, the ledger, ...) to the resource it belongs to. The objects call touch()
+// when they are read or modified. In debug builds, a touch made while a task runs
+// is checked against the resources the task declared: an undeclared access is a
+// data race the graph cannot see, and is reported once per task and resource. In
+// other builds touch() is empty.
+
+using ResourceSet = uint32_t;
+
+// What the running task declared, and where to look up the touched objects.
+struct TaskAccessScope {
+    const char *task = nullptr;
+    ResourceSet reads = 0;
+    ResourceSet writes = 0;
+    const std::vector<std::pair<const void*, ResourceSet>> *bindings = nullptr;
+    const char *const *resourceNames = nullptr;
+};
+
+class TaskAccess {
+public:
+    static void touch(const void *object, bool write) {
+#ifdef debug
+        const TaskAccessScope *scope = current();
+        if (scope && scope->bindings)
+            check(*scope, object, write);
+#else
+        (void)object;
+        (void)write;
+#endif
+    }
+
+    // Scope of the task running on this thread (nullptr outside the task graph).
+    static const TaskAccessScope *&current() {
+        static thread_local const TaskAccessScope *scope = nullptr;
+        return scope;
+    }
+
+    // Undeclared accesses reported since the start of the process.
+    static uint64_t violations() { return violationCount().load(); }
+
+private:
+    static std::atomic<uint64_t> &violationCount() {
+        static std::atomic<uint64_t> count{0};
+        return count;
+    }
+
+    static void check(const TaskAccessScope &scope, const void *object, bool write) {
+        for (const auto &binding : *scope.bindings) {
+            if (binding.first != object)
+                continue;
+            ResourceSet declared = write ? scope.writes : (scope.reads | scope.writes);
+            if (declared & binding.second)
+                return;
+            report(scope, binding.second, write);
+            return;
+        }
+    }
+
+    static void report(const TaskAccessScope &scope, ResourceSet resource, bool write) {
+        static std::mutex lock;
+        static std::vector<std::pair<const char*, ResourceSet>> reported;
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto &r : reported)
+            if (r.first == scope.task && r.second == resource)
+                return;
+        reported.push_back({scope.task, resource});
+        violationCount()++;
+        int bit = 0;
+        while (bit < 31 && !(resource & (1u << bit)))
+            bit++;
+        std::cerr << "Error: task " << scope.task << (write ? " writes " : " reads ")
+                  << (scope.resourceNames ? scope.resourceNames[bit] : "a resource")
+                  << " without declaring it\n";
+    }
+};
+
+#endif
@@ -0,0 +1,314 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include "TaskAccess.h"
+
+// A day of the simulation as a graph of tasks.
+//
+// Each task declares the resources (bits of a ResourceSet) it reads and writes. A task
+// depends on every earlier task that writes what it reads or writes, or reads what it
+// writes, so any schedule that respects the edges gives the result of running the
+// tasks in the order they were added. A task may be split into chunks, which run
+// concurrently; its successors start once every chunk has finished.
+
+struct TaskNode {
+    const char *name;
+    ResourceSet reads;
+    ResourceSet writes;
+    size_t chunks;
+    std::function<void(size_t)> body;     // Called once per chunk
+    std::vector<size_t> successors;
+    size_t predecessors = 0;
+};
+
+class TaskGraph {
+private:
+    std::vector<TaskNode> tasks;
+    std::vector<std::pair<const void*, ResourceSet>> bindings;
+    const char *const *resourceNames;
+
+public:
+    explicit TaskGraph(const char *const *names = nullptr) : resourceNames(names) {}
+
+    // Forget the tasks (the bindings are kept).
+    void clear() { tasks.clear(); }
+
+    // Attribute a shared object to a resource, for the debug race detector.
+    void bind(const void *object, ResourceSet resource) {
+        for (auto &b : bindings) {
+            if (b.first == object) {
+                b.second = resource;
+                return;
+            }
+        }
+        bindings.push_back({object, resource});
+    }
+
+    size_t add(const char *name, ResourceSet reads, ResourceSet writes, std::function<void()> body) {
+        return addChunked(name, reads, writes, 1, [body](size_t) { body(); });
+    }
+
+    size_t addChunked(const char *name, ResourceSet reads, ResourceSet writes, size_t chunks,
+                      std::function<void(size_t)> body) {
+        TaskNode node{name, reads, writes, std::max<size_t>(chunks, 1), std::move(body), {}, 0};
+        size_t id = tasks.size();
+        for (size_t t = 0; t < id; t++) {
+            const TaskNode &earlier = tasks[t];
+            if ((earlier.writes & (reads | writes)) || (earlier.reads & writes)) {
+                tasks[t].successors.push_back(id);
+                node.predecessors++;
+            }
+        }
+        tasks.push_back(std::move(node));
+        return id;
+    }
+
+    size_t size() const { return tasks.size(); }
+    const TaskNode &task(size_t t) const { return tasks[t]; }
+    TaskNode &task(size_t t) { return tasks[t]; }
+
+    // The race detector's view of task t.
+    TaskAccessScope scope(size_t t) const {
+        TaskAccessScope s;
+        s.task = tasks[t].name;
+        s.reads = tasks[t].reads;
+        s.writes = tasks[t].writes;
+        s.bindings = &bindings;
+        s.resourceNames = resourceNames;
+        return s;
+    }
+
+    // Run the tasks in the order they were added, on the calling thread.
+    void runSerial() {
+        const TaskAccessScope *outer = TaskAccess::current();
+        for (size_t t = 0; t < tasks.size(); t++) {
+            TaskAccessScope s = scope(t);
+            TaskAccess::current() = &s;
+            for (size_t c = 0; c < tasks[t].chunks; c++)
+                tasks[t].body(c);
+        }
+        TaskAccess::current() = outer;
+    }
+};
+
+// Work-stealing executor of task graphs and parallel loops.
+//
+// The pool keeps threads - 1 workers between days; the thread calling run() is worker
+// 0. Every worker owns a deque of runnable chunks: it pushes and pops at the back
+// (newest first, which keeps a task's successors on the core that produced their
+// inputs), and an idle worker steals from the front of another's deque. parallelFor
+// may be called from inside a task: its chunks go to the caller's deque, and the
+// caller runs chunks, its own or stolen, until the loop is done.
+class TaskScheduler {
+private:
+    // A unit of work: chunk `chunk` of a job.
+    struct Job;
+    struct Item {
+        Job *job;
+        size_t chunk;
+    };
+    struct Job {
+        const std::function<void(size_t)> *body = nullptr;
+        std::atomic<size_t> left{0};
+        TaskGraph *graph = nullptr;      // Set for the tasks of a graph
+        size_t task = 0;
+        std::atomic<size_t> predecessors{0};
+        const TaskAccessScope *scope = nullptr;  // Of the task that started a parallelFor
+    };
+    struct Queue {
+        std::mutex lock;
+        std::deque<Item> items;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex idleLock;
+    std::condition_variable wake;
+    std::atomic<uint64_t> epoch{0};      // Bumped whenever work is pushed or a graph ends
+    std::atomic<bool> stopping{false};
+
+    std::unique_ptr<Job[]> graphJobs;     // One per task of the running graph
+    std::atomic<size_t> tasksLeft{0};
+
+    static TaskScheduler *&currentScheduler() {
+        static thread_local TaskScheduler *scheduler = nullptr;
+        return scheduler;
+    }
+    static size_t &currentQueue() {
+        static thread_local size_t queue = 0;
+        return queue;
+    }
+
+    void signal() {
+        {
+            std::lock_guard<std::mutex> guard(idleLock);
+            epoch++;
+        }
+        wake.notify_all();
+    }
+
+    void push(size_t q, Job *job, size_t firstChunk, size_t chunks) {
+        {
+            std::lock_guard<std::mutex> guard(queues[q]->lock);
+            for (size_t c = firstChunk; c < chunks; c++)
+                queues[q]->items.push_back({job, c});
+        }
+        signal();
+    }
+
+    // Pop from the own deque's back, else steal from the front of another's.
+    bool take(size_t q, Item &item) {
+        {
+            Queue &own = *queues[q];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.items.empty()) {
+                item = own.items.back();
+                own.items.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues.size(); k++) {
+            Queue &victim = *queues[(q + k) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.items.empty()) {
+                item = victim.items.front();
+                victim.items.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(size_t q, const Item &item) {
+        Job *job = item.job;
+        TaskGraph *graph = job->graph;  // A finished parallelFor job may be gone below
+        const TaskAccessScope *outer = TaskAccess::current();
+        if (graph) {
+            TaskAccessScope s = graph->scope(job->task);
+            TaskAccess::current() = &s;
+            (*job->body)(item.chunk);
+        } else {
+            TaskAccess::current() = job->scope;
+            (*job->body)(item.chunk);
+        }
+        TaskAccess::current() = outer;
+        if (job->left.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        if (!graph) {
+            signal();  // The parallelFor waits for its last chunk
+            return;
+        }
+        // Task finished: release its successors onto this worker's deque.
+        for (size_t s : graph->task(job->task).successors) {
+            Job &next = graphJobs[s];
+            if (next.predecessors.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                push(q, &next, 0, graph->task(s).chunks);
+        }
+        if (tasksLeft.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            signal();
+    }
+
+    // Run work until done() holds, sleeping while there is nothing to take.
+    template <class Done>
+    void help(size_t q, Done done) {
+        while (!done()) {
+            uint64_t seen = epoch.load();
+            Item item;
+            if (take(q, item)) {
+                execute(q, item);
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(idleLock);
+            wake.wait(guard, [&] { return done() || epoch.load() != seen; });
+        }
+    }
+
+    void workerLoop(size_t q) {
+        currentScheduler() = this;
+        currentQueue() = q;
+        help(q, [this] { return stopping.load(); });
+    }
+
+public:
+    explicit TaskScheduler(int threads) {
+        size_t n = static_cast<size_t>(std::max(threads, 1));
+        for (size_t q = 0; q < n; q++)
+            queues.emplace_back(new Queue());
+        for (size_t q = 1; q < n; q++)
+            workers.emplace_back(&TaskScheduler::workerLoop, this, q);
+    }
+
+    ~TaskScheduler() {
+        stopping = true;
+        signal();
+        for (auto &w : workers)
+            w.join();
+    }
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    int getThreads() const { return static_cast<int>(queues.size()); }
+
+    // Run every task of the graph, overlapping those that do not conflict.
+    void run(TaskGraph &graph) {
+        if (queues.size() == 1) {
+            graph.runSerial();
+            return;
+        }
+        TaskScheduler *outerScheduler = currentScheduler();
+        size_t outerQueue = currentQueue();
+        currentScheduler() = this;
+        currentQueue() = 0;
+
+        graphJobs.reset(new Job[graph.size()]);
+        tasksLeft = graph.size();
+        for (size_t t = 0; t < graph.size(); t++) {
+            Job &job = graphJobs[t];
+            job.body = &graph.task(t).body;
+            job.left = graph.task(t).chunks;
+            job.graph = &graph;
+            job.task = t;
+            job.predecessors = graph.task(t).predecessors;
+        }
+        for (size_t t = 0; t < graph.size(); t++)
+            if (graph.task(t).predecessors == 0)
+                push(0, &graphJobs[t], 0, graph.task(t).chunks);
+        help(0, [this] { return tasksLeft.load() == 0; });
+
+        currentScheduler() = outerScheduler;
+        currentQueue() = outerQueue;
+    }
+
+    // Run body(0..n-1) on the pool and wait. From a thread outside the pool, or with a
+    // single thread, the chunks run in order on the calling thread.
+    void parallelFor(size_t n, const std::function<void(size_t)> &body) {
+        if (n == 0)
+            return;
+        if (queues.size() == 1 || n == 1 || currentScheduler() != this) {
+            for (size_t c = 0; c < n; c++)
+                body(c);
+            return;
+        }
+        size_t q = currentQueue();
+        Job job;
+        job.body = &body;
+        job.left = n;
+        job.scope = TaskAccess::current();
+        push(q, &job, 1, n);
+        execute(q, {&job, 0});
+        help(q, [&job] { return job.left.load() == 0; });
+    }
+};
+
+#endif
@@ -7,37 +7,149 @@
 #include <algorithm>
 #include <cstdlib>
 #include <random>
-#include <unordered_map>  // For tracking daysWithoutEat
+#include <functional>
 #include "FisherMan.h"
 #include "Firm.h"
 #include "FishingFirm.h"
 #include "JobMarket.h"
 #include "FishingMarket.h"
+#include "EmploymentIndex.h"
+#include "QuantileSketch.h"
+#include "MemoryAccounting.h"
+#include "DepositBank.h"
+#include "CentralBank.h"
+#include "ProductionNetwork.h"
+#include "FishingGround.h"
+#include "RandomStreams.h"
+#include "ModelPolicy.h"
+#include "TaskGraph.h"
+#include "Executor.h"
 
-class World {
+// Points of the day at which an observer (e.g. the golden-trace recorder) sees the world.
+enum class CyclePhase : uint32_t {
+    Wages = 0,       // After tile A: wages credited, the dead removed
+    Firms = 1,       // After the firms acted and the inactive ones were removed
+    Hiring = 2,      // After the job market's matches were hired
+    FishMarket = 3,  // After the fish market cleared (sales not yet reset)
+    EndOfDay = 4     // After tile C, with the day's indicators
+};
+
+// Shared state of the day, as the resources declared by the tasks of the cycle.
+struct CycleResource {
+    static constexpr ResourceSet Fishers = 1u << 0;      // The fishermen (but their employment) and their list
+    static constexpr ResourceSet Firms = 1u << 1;        // The firms (but their headcount) and their list
+    static constexpr ResourceSet Employment = 1u << 2;   // Employment index, employers and headcounts
+    static constexpr ResourceSet JobMarket = 1u << 3;    // Job market, the day's applicants and wage
+    static constexpr ResourceSet FishMarket = 1u << 4;   // Fish market and the day's offers
+    static constexpr ResourceSet Bank = 1u << 5;         // Ledger, deposit and central bank
+    static constexpr ResourceSet Network = 1u << 6;      // Production network and its suppliers
+    static constexpr ResourceSet Ground = 1u << 7;       // Fishing ground and the last catch
+    static constexpr ResourceSet Generator = 1u << 8;    // The simulation's generator (draws in call order)
+    static constexpr ResourceSet GlobalRand = 1u << 9;   // rand()
+    static constexpr ResourceSet Aggregates = 1u << 10;  // GDP, inflation and spoiled fish
+    static constexpr ResourceSet Indicators = 1u << 11;  // Unemployment and the wealth sketch
+    static constexpr ResourceSet All = (1u << 12) - 1;
+};
+
+inline const char *const *cycleResourceNames() {
+    static const char *names[] = {"Fishers", "Firms", "Employment", "JobMarket", "FishMarket", "Bank",
+                                  "Network", "Ground", "Generator", "GlobalRand", "Aggregates", "Indicators"};
+    return names;
+}
+
+template <class Model> class BasicWorld;
+
+// Read-only view of the world at each phase of every agent cycle.
+template <class Model>
+class BasicCycleObserver {
+public:
+    virtual ~BasicCycleObserver() {}
+    virtual void observe(const BasicWorld<Model> &world, CyclePhase phase) = 0;
+    // Where the observer may run parallel work while it observes (see Executor.h).
+    virtual void setExecutor(Executor executor) { (void)executor; }
+};
+
+using CycleObserver = BasicCycleObserver<RuntimeModel>;
+
+// A fisherman leaving his village, in a fixed layout so batches can be sent as raw bytes.
+struct MigrantRecord {
+    int destination;       // Global index of the destination village
+    int age;
+    int lifetime;
+    int daysWithoutEat;
+    int educationLevel;
+    int experienceLevel;
+    int jobPreference;
+    double funds;
+};
+
+// The village's agents and its daily pipeline. Model is a compile-time policy
+// (see ModelPolicy.h); World is the runtime-parameter build.
+template <class Model>
+class BasicWorld {
 private:
     int currentCycle;        // Current simulation day
     int totalCycles;         // Total simulation days
     double annualBirthRate;  // Annual birth rate (e.g., 0.02 for 2%)
 
-    std::vector<std::shared_ptr<FisherMan>> fishers;
-    std::vector<std::shared_ptr<Firm>> firms;
+    TrackedVector<std::shared_ptr<FisherMan>, MemoryTag::Fishers> fishers;
+    TrackedVector<std::shared_ptr<Firm>, MemoryTag::Firms> firms;
+    EmploymentIndex employment;  // Who works for which firm
     
     std::shared_ptr<JobMarket> jobMarket;
     std::shared_ptr<FishingMarket> fishingMarket;
 
     double previousFishPrice;  // For inflation calculation
-    double GDP;
+    money_t GDP;
     double unemploymentRate;
     double inflation;
 
     int maxStarvingDays;  // Maximum consecutive days without eating before death
-    // Mapping: fisherID -> consecutive days without eating
-    std::unordered_map<int, int> daysWithoutEat;
+    double dailyQuitProbability;  // End-of-day turnover probability (see setQuitProbability)
+    int unemployedCount;          // Unemployed fishermen at the end of the last cycle
+    int nextFisherID;             // Next unused fisherman ID (births and immigrants)
+    double priceFloor;            // Minimum offered fish price (0 = no floor)
+    QuantileSketch fundsSketch;   // Fishermen's funds at the end of the last cycle
+
+    // Banking (optional): every payment goes through the deposit bank's ledger.
+    std::shared_ptr<DepositBank> bank;
+    std::shared_ptr<CentralBank> centralBank;
+
+    // Production network (optional): investment buys capital goods from capital firms.
+    std::shared_ptr<ProductionNetwork> network;
+    int networkAccount;           // Clearing account of the network in the ledger
+
+    // Fishing ground (optional): firms can only sell the fish they catch from it.
+    std::shared_ptr<FishingGround> ground;
+    std::vector<double> lastCatch;    // Per fishery (employment slot), for mean-field stretches
+
+    // Perishable fish (optional): unsold fish is kept for shelfLife days and sold in
+    // freshness tiers (see submitFreshnessTiers).
+    int shelfLife;
+    double freshnessDiscount;     // Price cut per day of age (0 = one price, oldest fish first)
+    double lastSpoiled;           // Fish spoiled at the end of the last cycle
+
+    // Common random numbers (optional): the day's stochastic decisions are keyed
+    // draws (agent, purpose, cycle) instead of draws in call order.
+    bool keyedDraws;
+    RandomStreams streams;
+
+    BasicCycleObserver<Model> *observer;  // Not owned (nullptr = none)
+
+    // The day as a task graph (see buildCycle), run by a work-stealing pool.
+    TaskGraph cycle;
+    std::unique_ptr<TaskScheduler> scheduler;  // nullptr = serial (cycleThreads = 1)
+    int cycleThreads;
+    static constexpr size_t cycleGrain = 256;  // Fewest items per chunk of a split loop
+
+    // Handed from task to task during the day.
+    std::vector<FisherMan*> applicants;  // Parallel to the submitted applications
+    std::vector<FishOffering> dayOffers; // Collected with a fishing ground or perishable fish
+    double clearingWage;                 // The job market's clearing wage
 
 public:
     // Constructor now accepts maxStarvingDays as a parameter.
-    World(int cycles,
+    BasicWorld(int cycles,
           double annualBirthRate_,
           std::shared_ptr<JobMarket> jm,
           std::shared_ptr<FishingMarket> fm,
@@ -48,45 +160,289 @@ public:
           jobMarket(jm),
           fishingMarket(fm),
           previousFishPrice(fm->getClearingFishPrice()),
-          GDP(0.0),
+          GDP(),
           unemploymentRate(0.0),
           inflation(0.0),
-          maxStarvingDays(maxStarvingDays_)
-    {}
+          maxStarvingDays(maxStarvingDays_),
+          dailyQuitProbability(0.0),
+          unemployedCount(0),
+          nextFisherID(1000),
+          priceFloor(0.0),
+          networkAccount(-1),
+          shelfLife(0),
+          freshnessDiscount(0.0),
+          lastSpoiled(0.0),
+          keyedDraws(false),
+          observer(nullptr),
+          cycle(cycleResourceNames()),
+          cycleThreads(1),
+          clearingWage(0.0)
+    {
+        shareCycleThreads();
+    }
 
-    const std::vector<std::shared_ptr<FisherMan>>& getFishers() const {
+    const TrackedVector<std::shared_ptr<FisherMan>, MemoryTag::Fishers>& getFishers() const {
         return fishers;
     }
+    const TrackedVector<std::shared_ptr<Firm>, MemoryTag::Firms>& getFirms() const { return firms; }
+    std::shared_ptr<FishingMarket> getFishingMarket() const { return fishingMarket; }
+    int getCurrentCycle() const { return currentCycle; }
+    double getUnemploymentRate() const { return unemploymentRate; }
+    double getInflation() const { return inflation; }
+
+    // Let an observer see the world at every phase of each agent cycle.
+    void setObserver(BasicCycleObserver<Model> *o) {
+        observer = o;
+        shareCycleThreads();
+    }
 
     int getTotalFishers() const {
         return fishers.size();
     }
 
-    double getGDP() const {
+    money_t getGDP() const {
         return GDP;
     }
 
+    // Unemployed fishermen as counted at the end of the last simulated cycle.
     int getUnemployedFishers() const {
-        int count = 0;
-        for (const auto &fisher : fishers) {
-            if (!fisher->isEmployed()) {
-                count++;
-            }
-        }
-        return count;
+        return unemployedCount;
+    }
+
+    // Pre-size the population storage (bootstrap).
+    void reserveFishers(size_t n) {
+        fishers.reserve(n);
     }
 
     // Adds a fisherman and initializes his starvation counter.
     void addFisherMan(std::shared_ptr<FisherMan> f) {
+        nextFisherID = std::max(nextFisherID, f->getID() + 1);
+        f->setDaysWithoutEat(0);
+        if (bank)
+            f->setAccount(static_cast<int>(bank->getLedger().open(f->getFunds())));
+        if (!f->isEmployed())
+            unemployedCount++;
         fishers.push_back(f);
-        daysWithoutEat[f->getID()] = 0;
     }
 
     void addFirm(std::shared_ptr<Firm> f) {
+        if (bank)
+            f->setAccount(static_cast<int>(bank->getLedger().open(f->getFunds())));
+        if (network)
+            f->setNetworkRow(network->addBuyer(f.get()));
+        if (shelfLife > 0)
+            if (auto *fishing = dynamic_cast<FishingFirm*>(f.get()))
+                fishing->setShelfLife(shelfLife);
         firms.push_back(f);
+        employment.addFirm(f);
+        if (ground)
+            ground->setFisheries(employment.getSlotCount());
+    }
+
+    // Employ a fisherman at the firm with the given ID.
+    bool hire(FisherMan *fisher, int firmID, money_t wage) {
+        return employment.hire(fisher, firmID, wage);
+    }
+
+    // Fisherman leaves his employer.
+    void quit(FisherMan *fisher) {
+        employment.quit(fisher);
+    }
+
+    // Route the village's money through a deposit bank, whose rates follow the central
+    // bank. Agents added from now on get an account funded with their current funds.
+    void setBanking(std::shared_ptr<DepositBank> b, std::shared_ptr<CentralBank> cb) {
+        bank = b;
+        centralBank = cb;
+        shareCycleThreads();
+    }
+    std::shared_ptr<DepositBank> getBank() const { return bank; }
+
+    // Let the firms invest through a production network (set after setBanking and
+    // before the firms are added). Its suppliers get bank accounts, and payments go
+    // through a clearing account, so a day costs one payment per firm, not per link.
+    void setProductionNetwork(std::shared_ptr<ProductionNetwork> net) {
+        network = net;
+        shareCycleThreads();
+        if (network && bank) {
+            networkAccount = static_cast<int>(bank->getLedger().open());
+            for (auto &supplier : network->getSuppliers())
+                supplier->setAccount(static_cast<int>(bank->getLedger().open(supplier->getFunds())));
+        }
+    }
+    std::shared_ptr<ProductionNetwork> getProductionNetwork() const { return network; }
+
+    // Make the firms fish from a shared ground: each firm (employment slot) owns one
+    // fishery, and the ground regrows once per day after the fish market.
+    void setFishingGround(std::shared_ptr<FishingGround> g) {
+        ground = g;
+        shareCycleThreads();
+        if (ground)
+            ground->setFisheries(std::max<size_t>(employment.getSlotCount(), 1));
+    }
+    std::shared_ptr<FishingGround> getFishingGround() const { return ground; }
+    std::shared_ptr<CentralBank> getCentralBank() const { return centralBank; }
+
+    // Keep unsold fish for `days` days (set before the firms are added; 0 = unsold
+    // fish is discarded). discount is the price cut per day of age.
+    void setPerishable(int days, double discount) {
+        shelfLife = std::max(days, 0);
+        freshnessDiscount = discount;
+    }
+    void setFreshnessDiscount(double discount) { freshnessDiscount = discount; }
+    int getShelfLife() const { return shelfLife; }
+    double getLastSpoiled() const { return lastSpoiled; }
+    double getHeldCatch() const {
+        double held = 0.0;
+        for (const auto &firm : firms)
+            if (auto *fishing = dynamic_cast<FishingFirm*>(firm.get()))
+                held += fishing->getHeldCatch();
+        return held;
+    }
+
+    // Draw quits, births, prices and investment shares from keyed streams (see
+    // RandomStreams.h), so runs with the same seed share their randomness.
+    void setCommonRandomNumbers(bool on, uint64_t seed) {
+        keyedDraws = on;
+        streams.setSeed(seed);
     }
+    bool usesCommonRandomNumbers() const { return keyedDraws; }
+    const RandomStreams &getRandomStreams() const { return streams; }
 
+    // Parameters that may change during a run (scenario branches).
+    void setAnnualBirthRate(double rate) { annualBirthRate = rate; }
+    void setMaxStarvingDays(int days) { maxStarvingDays = days; }
+    void setPriceFloor(double floor) { priceFloor = floor; }
 
+    // Probability that an employed fisherman quits at the end of each day. The draw
+    // is made in the same pass that counts unemployment for the day's indicators.
+    void setQuitProbability(double pQuit) {
+        dailyQuitProbability = pQuit;
+    }
+
+    const EmploymentIndex& getEmployment() const {
+        return employment;
+    }
+
+    // Wealth distribution of the fishermen, filled during the end-of-day pass.
+    void setSketchAccuracy(size_t k) { fundsSketch.setAccuracy(k); }
+    const QuantileSketch& getFundsSketch() const { return fundsSketch; }
+
+    // A newborn fisherman with the next free ID (not yet added).
+    std::shared_ptr<FisherMan> makeNewborn() {
+        return std::allocate_shared<FisherMan>(TrackedAllocator<FisherMan, MemoryTag::Fishers>(),
+            nextFisherID,  // ID
+            0.0,           // Initial funds
+            365 * 60,      // Lifespan in days (e.g., 60 years)
+            0.0,           // Income (unused)
+            0.0,           // Savings
+            1.0,           // Job demand
+            1.0,           // Goods demand
+            false,         // Initially unemployed
+            0.0,           // Wage (will be set later)
+            0.0,           // Unemployment benefit (omitted)
+            "fishing",     // Job sector
+            1, 1, 1        // Education, Experience, Job preference
+        );
+    }
+
+    // Rematerialise the agents after a mean-field stretch of `days` days so that they
+    // match the aggregate state: everyone ages by `days` and those past their lifetime
+    // die, then newborns (aged 0..days-1) are added or random fishermen removed to
+    // reach targetPopulation, and fishermen are hired at `wage` or quit until
+    // targetUnemployed are out of work. Funds are carried over unchanged.
+    void fastForward(int days, int targetPopulation, int targetUnemployed, money_t wage,
+                     std::default_random_engine &generator) {
+        size_t kept = 0;
+        for (size_t i = 0; i < fishers.size(); i++) {
+            FisherMan *fisher = fishers[i].get();
+            fisher->setAge(fisher->getAge() + days);
+            if (fisher->getAge() >= fisher->getLifetime()) {
+                fisher->setActive(false);
+                employment.quit(fisher);
+                closeAccount(fisher);
+                continue;
+            }
+            if (kept != i)
+                fishers[kept] = std::move(fishers[i]);
+            kept++;
+        }
+        fishers.resize(kept);
+
+        targetPopulation = std::max(targetPopulation, 0);
+        std::uniform_int_distribution<int> birthAge(0, std::max(days - 1, 0));
+        while (static_cast<int>(fishers.size()) < targetPopulation) {
+            std::shared_ptr<FisherMan> newborn = makeNewborn();
+            newborn->setAge(birthAge(generator));
+            addFisherMan(newborn);
+        }
+        if (static_cast<int>(fishers.size()) > targetPopulation) {
+            std::shuffle(fishers.begin(), fishers.end(), generator);
+            for (size_t i = static_cast<size_t>(targetPopulation); i < fishers.size(); i++) {
+                fishers[i]->setActive(false);
+                employment.quit(fishers[i].get());
+                closeAccount(fishers[i].get());
+            }
+            fishers.resize(static_cast<size_t>(targetPopulation));
+        }
+
+        // Employment: hire round-robin over the firms, or lay off at random.
+        std::vector<FisherMan*> unemployed, employed;
+        for (auto &fisher : fishers)
+            (fisher->isEmployed() ? employed : unemployed).push_back(fisher.get());
+        targetUnemployed = std::min(std::max(targetUnemployed, 0), static_cast<int>(fishers.size()));
+        int surplus = static_cast<int>(unemployed.size()) - targetUnemployed;
+        if (surplus > 0 && !firms.empty()) {
+            std::shuffle(unemployed.begin(), unemployed.end(), generator);
+            for (int i = 0; i < surplus; i++)
+                employment.hire(unemployed[i], firms[i % firms.size()]->getID(), wage);
+        } else if (surplus < 0) {
+            std::shuffle(employed.begin(), employed.end(), generator);
+            for (int i = 0; i < -surplus && i < static_cast<int>(employed.size()); i++)
+                employment.quit(employed[i]);
+        }
+        unemployedCount = 0;
+        for (auto &fisher : fishers)
+            if (!fisher->isEmployed())
+                unemployedCount++;
+        // The fishing ground keeps being fished at the last agent day's catch.
+        if (ground) {
+            for (int d = 0; d < days; d++) {
+                ground->harvest(lastCatch);
+                ground->step();
+            }
+        }
+        currentCycle += days;
+    }
+
+    // Align the inflation reference after a mean-field stretch.
+    void setPreviousFishPrice(double price) {
+        previousFishPrice = price;
+    }
+
+
+
+    // Threads that run the day's task graph (1 = in the order of the serial day, on
+    // the calling thread). Large loops are split into chunks, and the chunks of the
+    // parallel phases (the fish market's partitions, the settlement, the network, the
+    // ground, the trace digests) run on the same pool: their own thread settings only
+    // say how many chunks to make.
+    void setCycleThreads(int threads) {
+        cycleThreads = std::max(threads, 1);
+        if (scheduler && scheduler->getThreads() == cycleThreads)
+            return;
+        scheduler.reset(cycleThreads > 1 ? new TaskScheduler(cycleThreads) : nullptr);
+        shareCycleThreads();
+    }
+    int getCycleThreads() const { return cycleThreads; }
+
+    // Join the pool's workers, so that the process can fork(); startCycleThreads()
+    // brings the pool back, in the parent and in each child.
+    void stopCycleThreads() {
+        scheduler.reset();
+        shareCycleThreads();
+    }
+    void startCycleThreads() { setCycleThreads(cycleThreads); }
 
     // simulateCycle() processes one simulation day.
     void simulateCycle(std::default_random_engine &generator,
@@ -94,208 +450,667 @@ public:
                        std::uniform_int_distribution<int> &goodsQuantityDist,
                        std::normal_distribution<double> &consumerPriceDist)
     {
+        (void)goodsQuantityDist;
 #if verbose==1
         std::cout << "=== Day " << currentCycle + 1 << " ===" << std::endl;
 #endif
-        // 1) Process FisherMen: Call act() to credit wages, then update() for consumption and aging.
-        for (auto &fisher : fishers) {
-            if (fisher->isActive())
-                fisher->act();   // Adds wage to funds
-        }
-        for (auto &fisher : fishers) {
-            if (fisher->isActive())
-                fisher->update();
-        }
-        // Remove fishermen who have become inactive (e.g., died or aged out).
-        fishers.erase(std::remove_if(fishers.begin(), fishers.end(),
-            [](const std::shared_ptr<FisherMan> &f) {
-                return !f->isActive();
-            }),
-            fishers.end());
-        
-        // 2) Process Firms: Call act() and update(), then remove inactive ones.
-        for (auto &firm : firms) {
-            if (firm->isActive())
-                firm->act();
-        }
-        for (auto &firm : firms) {
-            if (firm->isActive())
-                firm->update();
-        }
-        firms.erase(std::remove_if(firms.begin(), firms.end(),
-            [](const std::shared_ptr<Firm> &f) {
-                return !f->isActive();
-            }),
-            firms.end());
-        
+        buildCycle(generator, firmPriceDist, consumerPriceDist);
+        if (scheduler)
+            scheduler->run(cycle);
+        else
+            cycle.runSerial();
+
+        // Print the macro summary for the day.
+#if verbose==1
+        std::cout << "-----------" << std::endl;
+        std::cout << "Day " << currentCycle + 1 << " Summary:" << std::endl;
+        std::cout << "Population: " << getTotalFishers() << std::endl;
+        std::cout << "  GDP: " << GDP << std::endl;
+        std::cout << "  Unemployment Rate: " << unemploymentRate * 100 << "%" << std::endl;
+        std::cout << "  Inflation: " << inflation * 100 << "%" << std::endl;
+        std::cout << "=====================================" << std::endl;
+#endif 
+        if (observer)
+            observer->observe(*this, CyclePhase::EndOfDay);
+        currentCycle++;
+        // Reset the markets for the next cycle.
+        jobMarket->reset();
+        fishingMarket->reset();
+    }
+
+    // The day as a task graph. Tasks are added in the order of the serial day, each
+    // with the resources it reads and writes (see CycleResource), so the scheduler
+    // keeps that order between conflicting tasks and overlaps the others: tile A with
+    // the firms, births with the firm updates, the offered-price draws with the job
+    // market, and the ground's regrowth and the day's aggregates with tile C.
+    //
+    // The per-fisher work of the day is fused into three passes (tiles) separated by
+    // the two market clearings, so the population is streamed through cache three
+    // times instead of once per phase:
+    //   A) wage credit, aging, death removal and job application emission,
+    //   B) job turnover draw and fish order emission,
+    //   C) starvation update, death removal, end-of-day turnover and indicators.
+    void buildCycle(std::default_random_engine &generator,
+                    std::normal_distribution<double> &firmPriceDist,
+                    std::normal_distribution<double> &consumerPriceDist)
+    {
+        using R = CycleResource;
+        cycle.clear();
+        bindCycleResources(generator);
+        const ResourceSet banking = bank ? R::Bank : 0;
+        const ResourceSet generated = keyedDraws ? 0 : R::Generator;  // Draws in call order
+        const ResourceSet randUse = keyedDraws ? 0 : R::GlobalRand;    // rand()
+
+        // 1) Tile A: credit wages, age, drop the dead (in-place compaction), and
+        //    let the unemployed apply for a job.
+        cycle.add("TileA", 0, R::Fishers | R::Employment | R::JobMarket | banking, [this] { tileA(); });
+        observe(CyclePhase::Wages);
+
+        // 2) Process Firms: Call act() and update(), then remove inactive ones. Each
+        //    firm acts on its own state unless the draws come from rand() or the
+        //    network's generator.
+        size_t chunks = (keyedDraws && !network) ? chunksFor(firms.size()) : 1;
+        cycle.addChunked("FirmsAct", 0, R::Firms | (network ? R::Network : randUse), chunks,
+            [this, chunks](size_t c) {
+                TaskAccess::touch(&firms, true);
+                size_t n = firms.size();
+                for (size_t k = n * c / chunks; k < n * (c + 1) / chunks; k++)
+                    actFirm(*firms[k]);
+            });
+        if (network)
+            cycle.add("ClearNetwork", 0, R::Firms | R::Network | banking, [this] { clearNetwork(); });
+        chunks = chunksFor(firms.size());
+        cycle.addChunked("FirmsUpdate", 0, R::Firms, chunks, [this, chunks](size_t c) {
+            TaskAccess::touch(&firms, true);
+            size_t n = firms.size();
+            for (size_t k = n * c / chunks; k < n * (c + 1) / chunks; k++)
+                if (firms[k]->isActive())
+                    firms[k]->update();
+        });
+        cycle.add("FirmsRemoval", 0, R::Firms | R::Employment | banking | (network ? R::Network : 0),
+            [this] { removeInactiveFirms(); });
+        observe(CyclePhase::Firms);
+
         // 3) Population management: Create new fishermen using a Poisson distribution.
-        {
-            double dailyBirthRate = annualBirthRate / 365.0;
-            int currentPopulation = static_cast<int>(fishers.size());
-            double lambda = dailyBirthRate * currentPopulation;
-            std::poisson_distribution<int> poissonDist(lambda);
-            int newBirths = poissonDist(generator);
-            for (int i = 0; i < newBirths; i++) {
-                int newID = 1000 + fishers.size();
-                auto newFisher = std::make_shared<FisherMan>(
-                    newID,         // ID
-                    0.0,           // Initial funds
-                    365 * 60,      // Lifespan in days (e.g., 60 years)
-                    0.0,           // Income (unused)
-                    0.0,           // Savings
-                    1.0,           // Job demand
-                    1.0,           // Goods demand
-                    false,         // Initially unemployed
-                    0.0,           // Wage (will be set later)
-                    0.0,           // Unemployment benefit (omitted)
-                    "fishing",     // Job sector
-                    1, 1, 1        // Education, Experience, Job preference
-                );
-                addFisherMan(newFisher);
+        //    Newborns are unemployed, so they apply for a job straight away.
+        cycle.add("Births", 0, R::Fishers | R::JobMarket | R::Indicators | generated | banking,
+            [this, &generator] { births(generator); });
+
+        // 4) Job market process: Firms post jobs and the market is cleared (barrier).
+        cycle.add("JobPostings", R::Firms, R::JobMarket, [this] {
+            TaskAccess::touch(&firms, false);
+            for (auto &firm : firms) {
+                JobPosting posting = firm->generateJobPosting("fishing", 1, 1, 1);
+                jobMarket->submitJobPosting(posting);
             }
-        }
+        });
+        cycle.add("JobClearing", 0, R::JobMarket | R::Employment, [this, &generator] {
+            jobMarket->clear<Model>(generator);
+            clearingWage = jobMarket->getClearingWage();
+            money_t dailyWage = toMoney(1.5 * clearingWage);
 
-        // 4) Job market process: Firms post jobs; unemployed fishermen submit applications.
-        for (auto &firm : firms) {
-            JobPosting posting = firm->generateJobPosting("fishing", 1, 1, 1);
-            jobMarket->submitJobPosting(posting);
-        }
-        for (auto &fisher : fishers) {
-            if (!fisher->isEmployed()) {
-                JobApplication app = fisher->generateJobApplication();
-                jobMarket->submitJobApplication(app);
+            // Hire exactly the fishermen whose applications were matched.
+            for (const auto &match : jobMarket->getMatches()) {
+                if (match.application < applicants.size()) {
+                    employment.hire(applicants[match.application], match.firmID, dailyWage);
+                }
             }
-        }
-        jobMarket->clearMarket(generator);
-        double clearingWage = jobMarket->getClearingWage();
-        double dailyWage = 1.5 * clearingWage;
-        int matches = jobMarket->getMatchedJobs();
+        });
+        observe(CyclePhase::Hiring);
+        cycle.add("JobReset", 0, R::JobMarket, [this] {
+            jobMarket->print();
+            jobMarket->reset();
+            applicants.clear();
+        });
 
-        for (auto &fisher : fishers) {
-            if (!fisher->isEmployed() && matches > 0) {
-                fisher->setEmployed(true);
-                fisher->setWage(dailyWage);
-                matches--;
+        // 5) Fishing market process: each firm draws its offered price, then submits a
+        //    fish offering (with a fishing ground, only what it catches; see catchFish;
+        //    with perishable fish, its stock in freshness tiers; see submitFreshnessTiers).
+        chunks = keyedDraws ? chunksFor(firms.size()) : 1;
+        cycle.addChunked("PriceDraws", 0, R::Firms | generated, chunks,
+            [this, chunks, &generator, &firmPriceDist](size_t c) {
+                TaskAccess::touch(&firms, true);
+                size_t n = firms.size();
+                for (size_t k = n * c / chunks; k < n * (c + 1) / chunks; k++) {
+                    Firm &firm = *firms[k];
+                    double drawn = keyedDraws
+                        ? firmPriceDist.mean() + firmPriceDist.stddev()
+                              * streams.normal(firm.getID(), DrawPurpose::OfferedPrice, currentCycle)
+                        : generatorDraw(generator, firmPriceDist);
+                    firm.setPriceLevel(toMoney(std::max(drawn, priceFloor)));
+                }
+            });
+        cycle.add("Offers", R::JobMarket | R::Employment, R::Firms | R::FishMarket | (ground ? R::Ground : 0),
+            [this] { submitOffers(); });
+
+        // Tile B: job turnover (each employed fisherman quits with probability pQuit)
+        // and fish orders. Order i of the fish market belongs to fishers[i].
+        cycle.add("TileB", 0, R::Fishers | R::Employment | R::FishMarket | generated | randUse,
+            [this, &generator, &consumerPriceDist] { tileB(generator, consumerPriceDist); });
+
+        cycle.add("FishClearing", 0, R::Firms | R::FishMarket, [this, &generator] {
+            fishingMarket->clear<Model>(generator);
+        });
+        observe(CyclePhase::FishMarket);
+        cycle.add("FishReset", 0, R::FishMarket, [this] {
+            fishingMarket->print();
+            fishingMarket->reset();
+        });
+        if (ground)
+            cycle.add("GroundStep", 0, R::Ground, [this] { ground->step(); });
+
+        // 6) Compute daily GDP as the sum of firm revenues, then reset each firm's sales.
+        // 7) Calculate inflation based on changes in the fish market's clearing price.
+        cycle.add("Aggregates", R::FishMarket | (network ? R::Network : 0), R::Firms | R::Aggregates,
+            [this] { aggregates(); });
+
+        // Banking: pay for the fish bought, then settle the day (see settleDay).
+        if (bank)
+            cycle.add("Settlement", R::FishMarket | R::Fishers | R::Indicators,
+                R::Bank | R::Firms | (network ? R::Network : 0),
+                [this] { settleDay(fishingMarket->getClearingFishPrice()); });
+
+        // 8) Tile C: starvation check against the fish bought by each order, removal of
+        //    the starved, end-of-day turnover, the unemployment count and the wealth sketch.
+        cycle.add("TileC", R::FishMarket,
+            R::Fishers | R::Employment | R::Indicators | banking | (dailyQuitProbability > 0.0 ? randUse : 0),
+            [this] { tileC(); });
+    }
+
+    // Hand the pool to the parallel phases. Without one, their chunks run in order on
+    // the calling thread, so no phase starts threads during the day.
+    void shareCycleThreads() {
+        TaskScheduler *pool = scheduler.get();
+        Executor executor = [pool](size_t n, const std::function<void(size_t)> &body) {
+            if (pool) {
+                pool->parallelFor(n, body);
+                return;
             }
-        }
-        jobMarket->print();
-        jobMarket->reset();
+            for (size_t c = 0; c < n; c++)
+                body(c);
+        };
+        if (fishingMarket)
+            fishingMarket->setExecutor(executor);
+        if (bank)
+            bank->getLedger().setExecutor(executor);
+        if (network)
+            network->setExecutor(executor);
+        if (ground)
+            ground->setExecutor(executor);
+        if (observer)
+            observer->setExecutor(executor);
+    }
 
-        // NEW: Job Turnover Process
-        // Each employed fisherman quits with probability pQuit.
-        double pQuit = 0.05; // 1% chance to quit per day.
-        for (auto &fisher : fishers) {
+    // Split a loop over n items for the pool (1 chunk when the graph runs serially).
+    size_t chunksFor(size_t n) const {
+        if (!scheduler)
+            return 1;
+        size_t most = 4 * static_cast<size_t>(cycleThreads);
+        return std::max<size_t>(1, std::min(n / cycleGrain, most));
+    }
+
+    // Attribute the day's shared objects to their resources, for the race detector.
+    void bindCycleResources(std::default_random_engine &generator) {
+        using R = CycleResource;
+        cycle.bind(&fishers, R::Fishers);
+        cycle.bind(&firms, R::Firms);
+        cycle.bind(&employment, R::Employment);
+        cycle.bind(jobMarket.get(), R::JobMarket);
+        cycle.bind(fishingMarket.get(), R::FishMarket);
+        cycle.bind(&generator, R::Generator);
+        cycle.bind(randomSource(), R::GlobalRand);
+        if (bank)
+            cycle.bind(bank.get(), R::Bank);
+        if (network)
+            cycle.bind(network.get(), R::Network);
+        if (ground)
+            cycle.bind(ground.get(), R::Ground);
+    }
+
+    // Let the observer see the world once every earlier task is done.
+    void observe(CyclePhase phase) {
+        if (observer)
+            cycle.add("Observer", CycleResource::All, 0, [this, phase] { observer->observe(*this, phase); });
+    }
+
+    // Stands for rand()'s hidden state in the race detector.
+    static const void *randomSource() {
+        static const char source = 0;
+        return &source;
+    }
+
+    static double randDraw() {
+        TaskAccess::touch(randomSource(), true);
+        return static_cast<double>(rand()) / RAND_MAX;
+    }
+
+    template <class Distribution>
+    static typename Distribution::result_type generatorDraw(std::default_random_engine &generator,
+                                                            Distribution &dist) {
+        TaskAccess::touch(&generator, true);
+        return dist(generator);
+    }
+
+    void tileA() {
+        TaskAccess::touch(&fishers, true);
+        size_t kept = 0;
+        for (size_t i = 0; i < fishers.size(); i++) {
+            FisherMan *fisher = fishers[i].get();
             if (fisher->isEmployed()) {
-                double r = static_cast<double>(rand()) / RAND_MAX;
-                if (r < pQuit) {
-                    fisher->setEmployed(false);
-                    // Optionally, print a debug message:
-                    // std::cout << "FisherMan " << fisher->getID() << " has quit his job." << std::endl;
-                }
+                if (bank)
+                    payWage(fisher);
+                else
+                    fisher->creditWage();
+            }
+            fisher->update();
+            if (!fisher->isActive()) {
+                employment.quit(fisher);
+                closeAccount(fisher);
+                continue;
+            }
+            if (!fisher->isEmployed()) {
+                jobMarket->submitJobApplication(fisher->generateJobApplication());
+                applicants.push_back(fisher);
             }
+            if (kept != i)
+                fishers[kept] = std::move(fishers[i]);
+            kept++;
         }
+        fishers.resize(kept);
+    }
+
+    void actFirm(Firm &firm) {
+        if (!firm.isActive())
+            return;
+        double u = keyedDraws ? streams.uniform(firm.getID(), DrawPurpose::Investment, currentCycle) : -1.0;
+        firm.setInvestmentDraw(u);
+        if (!bank && !network) {
+            firm.act();
+            return;
+        }
+        if (network)
+            network->invest(firm.getNetworkRow(), toDouble(firm.getLastProfit()), u);
+        else
+            firm.invest();
+        if (!bank)
+            firm.bookProfit();
+    }
 
-        
+    void removeInactiveFirms() {
+        TaskAccess::touch(&firms, true);
+        firms.erase(std::remove_if(firms.begin(), firms.end(),
+            [this](const std::shared_ptr<Firm> &f) {
+                if (f->isActive())
+                    return false;
+                employment.removeFirm(f->getID());
+                closeAccount(f.get());
+                if (network)
+                    network->removeBuyer(f->getNetworkRow());
+                return true;
+            }),
+            firms.end());
+    }
 
-        
-        // 5) Fishing market process: Firms submit fish offerings and fishermen submit orders.
+    void births(std::default_random_engine &generator) {
+        double dailyBirthRate = annualBirthRate / 365.0;
+        int currentPopulation = static_cast<int>(fishers.size());
+        double lambda = dailyBirthRate * currentPopulation;
+        int newBirths;
+        if (keyedDraws) {
+            newBirths = streams.poisson(lambda, 0, DrawPurpose::Birth, currentCycle);
+        } else {
+            std::poisson_distribution<int> poissonDist(lambda);
+            newBirths = generatorDraw(generator, poissonDist);
+        }
+        TaskAccess::touch(&fishers, true);
+        for (int i = 0; i < newBirths; i++) {
+            std::shared_ptr<FisherMan> newFisher = makeNewborn();
+            addFisherMan(newFisher);
+            jobMarket->submitJobApplication(newFisher->generateJobApplication());
+            applicants.push_back(newFisher.get());
+        }
+    }
+
+    void submitOffers() {
+        TaskAccess::touch(&firms, true);
+        dayOffers.clear();
+        bool collect = ground || shelfLife > 0;
+        std::vector<FishOffering> imports;  // Fish bought from other villages (see shipFish)
         for (auto &firm : firms) {
-            double newPrice = firmPriceDist(generator);
-            firm->setPriceLevel(newPrice);
-            firm->setWageExpense(clearingWage);
+            firm->setWageExpense(toMoney(clearingWage));
             // Generate an offering; parameter (e.g., 2.0) can be adjusted.
             FishOffering offer = dynamic_cast<FishingFirm*>(firm.get())->generateGoodsOffering(2.0);
             offer.firm = std::dynamic_pointer_cast<FishingFirm>(firm);
-            fishingMarket->submitFishOffering(offer);
+            double imported = offer.firm->takeImports();
+            if (imported > 0.0) {
+                imports.push_back(offer);
+                imports.back().quantity = imported;
+            }
+            if (collect)
+                dayOffers.push_back(offer);
+            else
+                fishingMarket->submitFishOffering(offer);
         }
+        if (ground)
+            catchFish(dayOffers);
+        if (shelfLife > 0)
+            submitFreshnessTiers(dayOffers);
+        else if (ground)
+            for (const auto &offer : dayOffers)
+                fishingMarket->submitFishOffering(offer);
+        for (const auto &offer : imports)
+            fishingMarket->submitFishOffering(offer);
+    }
+
+    void tileB(std::default_random_engine &generator, std::normal_distribution<double> &consumerPriceDist) {
+        TaskAccess::touch(&fishers, true);
+        double pQuit = 0.05; // 1% chance to quit per day.
         for (auto &fisher : fishers) {
+            if (fisher->isEmployed()) {
+                double r = keyedDraws
+                    ? streams.uniform(fisher->getID(), DrawPurpose::Quit, currentCycle)
+                    : randDraw();
+                if (r < pQuit) {
+                    employment.quit(fisher.get());
+                }
+            }
             FishOrder order;
             order.id = fisher->getID();
-            order.desiredSector = "fishing";
+            if constexpr (!Model::singleSector)
+                order.desiredSector = "fishing";
             order.quantity = 1 ; 
-            order.perceivedValue = consumerPriceDist(generator);
+            order.perceivedValue = toMoney(keyedDraws
+                ? consumerPriceDist.mean() + consumerPriceDist.stddev()
+                      * streams.normal(fisher->getID(), DrawPurpose::PerceivedPrice, currentCycle)
+                : generatorDraw(generator, consumerPriceDist));
             order.availableFunds = fisher->getFunds();
             // Set hungry to true if the fisher's daysWithoutEat counter is not 0.
-            order.hungry = (daysWithoutEat[fisher->getID()] > 0);
+            order.hungry = (fisher->getDaysWithoutEat() > 0);
             fishingMarket->submitFishOrder(order);
         }
+    }
 
-        fishingMarket->clearMarket(generator);
-        fishingMarket->print();
-        fishingMarket->reset();
-        
-        // 6) Compute daily GDP as the sum of firm revenues, then reset each firm's sales.
-        double dailyGDP = 0.0;
+    void aggregates() {
+        TaskAccess::touch(&firms, true);
+        if (shelfLife > 0) {
+            lastSpoiled = 0.0;
+            for (const auto &offer : dayOffers)
+                if (offer.firm)
+                    lastSpoiled += offer.firm->ageCatch();
+        }
+        money_t dailyGDP = money_t();
         for (auto &firm : firms) {
             dailyGDP += firm->getRevenue();
         }
+        if (network)
+            dailyGDP += toMoney(network->getSales());
         GDP = dailyGDP;
         for (auto &firm : firms) {
             firm->resetSales();
         }
-        
-        // 7) Calculate the unemployment rate.
-        int unemployedCount = 0;
-        for (const auto &fisher : fishers) {
+
+        double currFishPrice = fishingMarket->getClearingFishPrice();
+        inflation = (previousFishPrice > 0.0)
+                    ? (currFishPrice - previousFishPrice) / previousFishPrice
+                    : 0.0;
+        previousFishPrice = currFishPrice;
+    }
+
+    void tileC() {
+        TaskAccess::touch(&fishers, true);
+        const auto &bought = fishingMarket->getOrderFills();
+        size_t kept = 0;
+        unemployedCount = 0;
+        fundsSketch.clear();
+        for (size_t i = 0; i < fishers.size(); i++) {
+            FisherMan *fisher = fishers[i].get();
+            if (bank)
+                fisher->setFunds(bank->getLedger().getBalance(static_cast<Ledger::Account>(fisher->getAccount())));
+            // A fisherman who did not purchase at least 1 fish gets one more day without eating.
+            fisher->recordMeal(i < bought.size() && bought[i] >= 1.0);
+            if (fisher->getDaysWithoutEat() >= maxStarvingDays) {
+                fisher->setActive(false);
+                employment.quit(fisher);
+                closeAccount(fisher);
+                continue;
+            }
+            if (fisher->isEmployed() && dailyQuitProbability > 0.0) {
+                double r = keyedDraws
+                    ? streams.uniform(fisher->getID(), DrawPurpose::Turnover, currentCycle)
+                    : randDraw();
+                if (r < dailyQuitProbability) {
+                    employment.quit(fisher);
+                }
+            }
             if (!fisher->isEmployed())
                 unemployedCount++;
+            fundsSketch.insert(toDouble(fisher->getFunds()));
+            if (kept != i)
+                fishers[kept] = std::move(fishers[i]);
+            kept++;
         }
+        fishers.resize(kept);
         unemploymentRate = (fishers.size() > 0)
                            ? static_cast<double>(unemployedCount) / fishers.size()
                            : 0.0;
+    }
 
-        // 8) Calculate inflation based on changes in the fish market's clearing price.
-        static double prevFishPrice = fishingMarket->getClearingFishPrice();
-        double currFishPrice = fishingMarket->getClearingFishPrice();
-        inflation = (prevFishPrice > 0.0)
-                    ? (currFishPrice - prevFishPrice) / prevFishPrice
-                    : 0.0;
-        prevFishPrice = currFishPrice;
+    // ---- Regional exchange (inter-village trade and migration) ----
 
-        // 9) Starvation Check:
-        // Retrieve the mapping of purchases (fisherID -> total fish bought) for this cycle.
-        std::unordered_map<int, double> purchases = fishingMarket->getPurchases();
+    // Fish the village can export: with a shelf life, the stock firms still hold after
+    // ageing; otherwise the day's unsold fish, which would be discarded.
+    double getUnsoldFish() const {
+        if (shelfLife <= 0)
+            return fishingMarket->getUnsoldVolume();
+        double held = 0.0;
+        for (const auto &firm : firms)
+            if (auto fishing = dynamic_cast<const FishingFirm*>(firm.get()))
+                held += fishing->getHeldCatch();
+        return held;
+    }
+    double getUnmetDemand() const { return fishingMarket->getUnmetDemand(); }
 
-        // Update the starvation counter for each fisherman.
-        for (auto &fisher : fishers) {
-            int fID = fisher->getID();
-            if (purchases.find(fID) == purchases.end() || purchases[fID] < 1.0) {
-                // If the fisherman did not purchase at least 1 fish, increment his starvation counter.
-                daysWithoutEat[fID]++;
-            } else {
-                // Otherwise, reset the counter.
-                daysWithoutEat[fID] = 0;
+    // Ship fish in and out of the village at unitPrice per fish; the firms' stock (their
+    // fishing capacity) is left alone. Exports come out of the unsold fish: with a shelf
+    // life, from each firm's held catch in proportion to it, otherwise from the day's
+    // unsold fish, shared evenly. Imports are shared evenly among the firms, which pay
+    // for them and sell them: landed in their perishable stock, or offered at the next
+    // fish-market clearing.
+    void shipFish(double imported, double exported, money_t unitPrice) {
+        if (firms.empty())
+            return;
+        double held = shelfLife > 0 ? getUnsoldFish() : 0.0;
+        double share = imported / static_cast<double>(firms.size());
+        for (auto &firm : firms) {
+            auto fishing = dynamic_cast<FishingFirm*>(firm.get());
+            if (!fishing)
+                continue;
+            double out = 0.0;
+            if (exported > 0.0) {
+                if (shelfLife <= 0)
+                    out = exported / static_cast<double>(firms.size());
+                else if (held > 0.0)
+                    out = fishing->exportCatch(exported * fishing->getHeldCatch() / held);
             }
+            if (share > 0.0)
+                fishing->importCatch(share);
+            money_t paid = unitPrice * (share - out);
+            firm->setFunds(firm->getFunds() - paid);
+            if (bank)
+                bank->getLedger().deposit(static_cast<Ledger::Account>(firm->getAccount()), -paid);
         }
+    }
 
-        // Mark fishermen as inactive if they exceed the maximum allowed days without eating.
-        for (auto &fisher : fishers) {
-            int fID = fisher->getID();
-            if (daysWithoutEat[fID] >= maxStarvingDays) {
-                fisher->setActive(false);
+    // Each unemployed fisherman leaves with probability rate; destinations are drawn
+    // uniformly among the other villages. Emigrants are removed from the village.
+    std::vector<MigrantRecord> emigrate(double rate, int selfIndex, int villages,
+                                        std::default_random_engine &generator) {
+        std::vector<MigrantRecord> out;
+        if (rate <= 0.0 || villages < 2)
+            return out;
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        std::uniform_int_distribution<int> other(0, villages - 2);
+        size_t kept = 0;
+        for (size_t i = 0; i < fishers.size(); i++) {
+            FisherMan *fisher = fishers[i].get();
+            if (!fisher->isEmployed() && u(generator) < rate) {
+                MigrantRecord r;
+                r.destination = other(generator);
+                if (r.destination >= selfIndex)
+                    r.destination++;
+                r.age = fisher->getAge();
+                r.lifetime = fisher->getLifetime();
+                r.daysWithoutEat = fisher->getDaysWithoutEat();
+                r.educationLevel = fisher->getEducationLevel();
+                r.experienceLevel = fisher->getExperienceLevel();
+                r.jobPreference = fisher->getJobPreference();
+                r.funds = toDouble(fisher->getFunds());
+                out.push_back(r);
+                if (bank)
+                    bank->getLedger().close(static_cast<Ledger::Account>(fisher->getAccount()), true);
+                unemployedCount--;
+                continue;
             }
+            if (kept != i)
+                fishers[kept] = std::move(fishers[i]);
+            kept++;
         }
-        // Remove inactive fishermen.
-        fishers.erase(std::remove_if(fishers.begin(), fishers.end(),
-            [](const std::shared_ptr<FisherMan>& f) {
-                return !f->isActive();
-            }),
-            fishers.end());
+        fishers.resize(kept);
+        return out;
+    }
 
-        // Print the macro summary for the day.
+    // Settle an arriving fisherman as an unemployed villager with a fresh local ID.
+    void immigrate(const MigrantRecord &r) {
+        auto fisher = std::allocate_shared<FisherMan>(TrackedAllocator<FisherMan, MemoryTag::Fishers>(),
+            nextFisherID, r.funds, r.lifetime, 0.0, 0.0, 1.0, 1.0, false,
+            0.0, 0.0, "fishing", r.educationLevel, r.experienceLevel, r.jobPreference);
+        fisher->setAge(r.age);
+        addFisherMan(fisher);
+        fisher->setDaysWithoutEat(r.daysWithoutEat);
+    }
+
+    // ---- Fishing ground ----
+
+    // Each firm's offering is cut to what it catches from its fishery.
+    void catchFish(std::vector<FishOffering> &offers) {
+        std::vector<double> desired(ground->getFisheries(), 0.0);
+        std::vector<int> fishery(offers.size(), -1);
+        for (size_t k = 0; k < offers.size(); k++) {
+            fishery[k] = employment.getSlot(offers[k].id);
+            if (fishery[k] >= 0 && fishery[k] < static_cast<int>(desired.size()))
+                desired[fishery[k]] += offers[k].quantity;
+        }
+        lastCatch = ground->harvest(desired);
+        for (size_t k = 0; k < offers.size(); k++) {
+            int f = fishery[k];
+            offers[k].quantity = (f >= 0 && f < static_cast<int>(lastCatch.size())) ? lastCatch[f] : 0.0;
+        }
+    }
+
+    // ---- Perishable fish ----
+
+    // Land each firm's catch in its perishable stock, then offer the stock one
+    // freshness tier (age) at a time, so the market's first-match clearing sells in
+    // tier order. Without a discount every tier has the firm's price and the oldest
+    // tiers come first (FIFO); with one, fish of age a costs price * (1 - discount)^a
+    // and the freshest tiers come first, so buyers who value fish less fall through
+    // to the cheaper, older fish. O(shelfLife) per firm.
+    void submitFreshnessTiers(const std::vector<FishOffering> &offers) {
+        for (const auto &offer : offers)
+            if (offer.firm)
+                offer.firm->landCatch(offer.quantity);
+        for (int k = 0; k < shelfLife; k++) {
+            int age = (freshnessDiscount > 0.0) ? k : shelfLife - 1 - k;
+            double factor = std::pow(1.0 - freshnessDiscount, age);
+            for (const auto &offer : offers) {
+                double quantity = offer.firm ? offer.firm->getFreshStock(age) : 0.0;
+                if (quantity <= 0.0)
+                    continue;
+                FishOffering tier = offer;
+                tier.age = age;
+                tier.quantity = quantity;
+                if (age > 0 && freshnessDiscount > 0.0)
+                    tier.offeredPrice = toMoney(toDouble(offer.offeredPrice) * factor);
+                fishingMarket->submitFishOffering(tier);
+            }
+        }
+    }
+
+    // ---- Production network ----
+
+    // Clear the day's capital-goods orders, then move the money: each buyer pays what
+    // it received and each supplier is paid its sales.
+    void clearNetwork() {
+        network->clear();
+        const auto &suppliers = network->getSuppliers();
+        for (auto &firm : firms) {
+            money_t spent = toMoney(network->getSpent(firm->getNetworkRow()));
+            if (spent <= money_t())
+                continue;
+            if (bank)
+                bank->getLedger().pay(static_cast<Ledger::Account>(firm->getAccount()),
+                                      static_cast<Ledger::Account>(networkAccount), spent, PaymentKind::Purchase);
+            else
+                firm->setFunds(firm->getFunds() - spent);
+        }
+        for (size_t j = 0; j < suppliers.size(); j++) {
+            money_t sales = toMoney(network->getRevenue(j));
+            if (sales <= money_t())
+                continue;
+            if (bank)
+                bank->getLedger().pay(static_cast<Ledger::Account>(networkAccount),
+                                      static_cast<Ledger::Account>(suppliers[j]->getAccount()), sales, PaymentKind::Purchase);
+            else
+                suppliers[j]->setFunds(suppliers[j]->getFunds() + sales);
+        }
+    }
+
+    // ---- Banking ----
+
+    // Queue today's wage from the fisherman's employer.
+    void payWage(FisherMan *fisher) {
+        int slot = fisher->getEmployerSlot();
+        int employer = slot >= 0 ? employment.getFirmAccount(slot) : -1;
+        if (employer >= 0)
+            bank->getLedger().pay(static_cast<Ledger::Account>(employer),
+                                  static_cast<Ledger::Account>(fisher->getAccount()),
+                                  fisher->getWage(), PaymentKind::Wage);
+    }
+
+    // Close a departed agent's account at the next settlement.
+    void closeAccount(Agent *agent) {
+        if (bank && agent->getAccount() >= 0) {
+            bank->getLedger().close(static_cast<Ledger::Account>(agent->getAccount()));
+            agent->setAccount(-1);
+        }
+    }
+
+    // End of the day: queue each order's payment to the firm it bought from, let the
+    // central bank observe the fish price (and the last unemployment rate) and decide,
+    // and settle every queued payment. Firms' funds are refreshed here, fishermen's
+    // in Tile C.
+    void settleDay(double fishPrice) {
+        Ledger &ledger = bank->getLedger();
+        const auto &spend = fishingMarket->getOrderSpend();
+        const auto &sellers = fishingMarket->getOrderSellers();
+        for (size_t i = 0; i < fishers.size() && i < spend.size(); i++) {
+            if (sellers[i] >= 0 && fishers[i]->getAccount() >= 0)
+                ledger.pay(static_cast<Ledger::Account>(fishers[i]->getAccount()),
+                           static_cast<Ledger::Account>(sellers[i]), spend[i], PaymentKind::Purchase);
+        }
+        centralBank->observe(fishPrice, unemploymentRate);
+        centralBank->act();
+        bank->setPolicyRate(centralBank->getPolicyRate());
+        bank->act();
+        for (auto &firm : firms)
+            firm->setFunds(ledger.getBalance(static_cast<Ledger::Account>(firm->getAccount())));
+        if (network)
+            for (auto &supplier : network->getSuppliers())
+                supplier->setFunds(ledger.getBalance(static_cast<Ledger::Account>(supplier->getAccount())));
 #if verbose==1
-        std::cout << "-----------" << std::endl;
-        std::cout << "Day " << currentCycle + 1 << " Summary:" << std::endl;
-        std::cout << "Population: " << getTotalFishers() << std::endl;
-        std::cout << "  GDP: " << GDP << std::endl;
-        std::cout << "  Unemployment Rate: " << unemploymentRate * 100 << "%" << std::endl;
-        std::cout << "  Inflation: " << inflation * 100 << "%" << std::endl;
-        std::cout << "=====================================" << std::endl;
-#endif 
-        currentCycle++;
-        // Reset the markets for the next cycle.
-        jobMarket->reset();
-        fishingMarket->reset();
+        centralBank->print();
+        bank->print();
+#endif
     }
 
     void printWorldState() const {
@@ -307,4 +1122,6 @@ public:
     }
 };
 
+using World = BasicWorld<RuntimeModel>;
+
 #endif // WORLD_H
@@ -0,0 +1,196 @@
+// Runtime-parameter build against compile-time model policies (see World/ModelPolicy.h).
+//
+//   benchmark.exe [options]
+//     --days n          days per run (default 300)
+//     --fishers n       initial population (default 2000; firms, jobs and employment scale with it)
+//     --seed s          seed (default 1)
+//     --repeats n       timed runs of each build; the fastest counts (default 3)
+//     --threads n       fish-market partitions (default 1)
+//     --crn             common random numbers
+//
+// Both builds run the same village from the same seed; their daily series must be
+// identical, since a policy only fixes what the village already does.
+//
+// It also checks the goods market's divisible path (see GoodsMarket.h), which the
+// village does not use: on books where every order accepts every price, partitioned
+// clearing must trade as much as the serial loop.
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <cmath>
+#include "Simulation.h"
+
+using namespace std;
+
+// Daily series of one run, compared between the builds.
+struct BenchmarkRun {
+    double seconds = 0.0;
+    vector<double> series;
+};
+
+template <class Model>
+static BenchmarkRun timeModel(const SimulationParameters &p, int repeats) {
+    BenchmarkRun best;
+    for (int r = 0; r < repeats; r++) {
+        srand(1);
+        auto start = chrono::high_resolution_clock::now();
+        BasicSimulation<Model> sim(p);
+        while (!sim.finished())
+            sim.advance();
+        chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+        if (r == 0 || elapsed.count() < best.seconds)
+            best.seconds = elapsed.count();
+        if (r == 0) {
+            for (size_t d = 0; d < sim.getGDPs().size(); d++) {
+                best.series.push_back(sim.getGDPs()[d]);
+                best.series.push_back(sim.getPopulations()[d]);
+                best.series.push_back(sim.getUnemploymentRates()[d]);
+                best.series.push_back(sim.getFishPrices()[d]);
+            }
+        }
+    }
+    return best;
+}
+
+// Fish sold by weight: divisible, and kept off the firms' freshness tiers.
+struct WeighedFish : FishGood {
+    static constexpr bool perishable = false;
+    static constexpr bool divisible = true;
+};
+
+// Traded volume and unsold stock of one book, cleared with the given partitions.
+static void clearBook(const vector<FishOffering> &offers, const vector<FishOrder> &orders, int partitions,
+                      double &traded, double &unsold) {
+    GoodsMarket<WeighedFish> market(5.0);
+    market.setClearingThreads(partitions);
+    for (const auto &o : offers)
+        market.submitOffering(o);
+    for (const auto &o : orders)
+        market.submitOrder(o);
+    default_random_engine generator(1);
+    market.clearMarket(generator);
+    traded = 0.0;
+    for (double q : market.getOrderFills())
+        traded += q;
+    unsold = market.getUnsoldVolume();
+}
+
+// Partitioned against serial clearing of divisible goods; returns the books that differ.
+static int checkDivisibleClearing(unsigned int seed) {
+    default_random_engine generator(seed);
+    uniform_real_distribution<double> quantity(0.0, 4.0), price(4.0, 6.0);
+    uniform_int_distribution<int> count(1, 60);
+    int failures = 0;
+    for (int book = 0; book < 50; book++) {
+        vector<FishOffering> offers;
+        vector<FishOrder> orders;
+        if (book == 0) {
+            // Two offerings, and an order larger than its partition's shares of both.
+            offers = {FishOffering(), FishOffering()};
+            offers[0].quantity = 2.5;
+            offers[1].quantity = 3.0;
+            orders = {FishOrder(), FishOrder()};
+            orders[0].quantity = 4.0;
+            orders[1].quantity = 2.0;
+            for (auto &o : offers)
+                o.offeredPrice = toMoney(3.0);
+        } else {
+            offers.resize(static_cast<size_t>(count(generator)) / 2 + 1);
+            orders.resize(static_cast<size_t>(count(generator)));
+            for (auto &o : offers) {
+                o.quantity = quantity(generator);
+                o.offeredPrice = toMoney(price(generator));
+            }
+            for (auto &o : orders)
+                o.quantity = quantity(generator);
+        }
+        for (size_t i = 0; i < offers.size(); i++) {
+            offers[i].id = static_cast<int>(i);
+            offers[i].productSector = "fishing";
+        }
+        for (size_t i = 0; i < orders.size(); i++) {
+            orders[i].id = static_cast<int>(i);
+            orders[i].desiredSector = "fishing";
+            orders[i].perceivedValue = toMoney(6.0);
+            orders[i].hungry = false;
+            orders[i].availableFunds = toMoney(0.0);
+        }
+        double serialTraded, serialUnsold;
+        clearBook(offers, orders, 1, serialTraded, serialUnsold);
+        for (int partitions = 2; partitions <= 4; partitions++) {
+            double traded, unsold;
+            clearBook(offers, orders, partitions, traded, unsold);
+            if (fabs(traded - serialTraded) > 1e-9 * (1.0 + serialTraded)
+                || fabs(unsold - serialUnsold) > 1e-9 * (1.0 + serialUnsold)) {
+                cerr << "Error: book " << book << " with " << partitions << " partitions trades "
+                     << traded << " instead of " << serialTraded << endl;
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+static void usage() {
+    cerr << "usage: benchmark.exe [--days n] [--fishers n] [--seed s] [--repeats n] [--threads n] [--crn]" << endl;
+}
+
+int main(int argc, char **argv) {
+    int days = 300;
+    int fishers = 2000;
+    unsigned int seed = 1;
+    int repeats = 3;
+    int threads = 1;
+    bool common = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--days" && i + 1 < argc) {
+            days = max(1, atoi(argv[++i]));
+        } else if (arg == "--fishers" && i + 1 < argc) {
+            fishers = max(1, atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<unsigned int>(max(1ul, strtoul(argv[++i], nullptr, 10)));
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            repeats = max(1, atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = max(1, atoi(argv[++i]));
+        } else if (arg == "--crn") {
+            common = true;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    SimulationParameters p;
+    p.seed = seed;
+    p.outputPath = "";
+    p.totalCycles = days;
+    p.totalFisherMen = fishers;
+    p.totalFirms = max(1, static_cast<int>(0.08 * fishers));
+    p.initialEmployed = static_cast<int>(0.90 * fishers);
+    p.totalJobOffers = static_cast<int>(0.10 * fishers);
+    p.marketThreads = threads;
+    p.commonRandomNumbers = common;
+
+    BenchmarkRun runtime = timeModel<RuntimeModel>(p, repeats);
+    BenchmarkRun village = timeModel<VillageModel>(p, repeats);
+    bool same = runtime.series == village.series;
+
+    cout << days << " days, " << fishers << " fishers, best of " << repeats << endl;
+    cout << "   RuntimeModel: " << runtime.seconds << " seconds (" << runtime.seconds / days * 1e3
+         << " ms per day)" << endl;
+    cout << "   VillageModel: " << village.seconds << " seconds (" << village.seconds / days * 1e3
+         << " ms per day)" << endl;
+    cout << "   speed-up = " << runtime.seconds / village.seconds << "x, series "
+         << (same ? "identical" : "DIFFER") << endl;
+    int divisible = checkDivisibleClearing(seed);
+    cout << "   divisible goods: partitioned clearing "
+         << (divisible == 0 ? "matches serial" : "DIFFERS from serial") << endl;
+    return (same && divisible == 0) ? 0 : 2;
+}
@@ -0,0 +1,158 @@
+// Calibration of the simulation parameters against a target series (see World/Calibration.h).
+//
+//   calibrate.exe <target.csv> [options]
+//     --columns a,b,...     target columns to fit (default Population,Unemployment,GDPperCapita)
+//     --params a,b,...      parameters to calibrate (default offeredPriceMean,perceivedPriceMean,
+//                           pQuit,employeeEfficiency); name=lo:hi overrides the bounds
+//     --moments             fit the mean and standard deviation of each column, not the series
+//     --threads n           candidates run at once (default: all cores; more than one
+//                           turns on --crn)
+//     --iterations n        Nelder-Mead iterations (default 60)
+//     --tolerance x         convergence tolerance (default 1e-3)
+//     --checkpoints n       early-stopping checks per run (default 4, 0 = none)
+//     --fishers n           initial population (default 100; firms, jobs and employment scale with it)
+//     --seed s              seed of every candidate run (default 1)
+//     --crn                 common random numbers (always on with more than one thread)
+//     --out file            best-fit parameters (default calibration_best.csv)
+//     --trace file          convergence trace (default calibration_trace.csv)
+//
+// Each candidate runs for as many days as the target has rows.
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include "Calibration.h"
+
+using namespace std;
+
+static void usage() {
+    cerr << "usage: calibrate.exe <target.csv> [--columns a,b] [--params a,b=lo:hi] [--moments]"
+         << " [--threads n] [--iterations n] [--tolerance x] [--checkpoints n] [--fishers n]"
+         << " [--seed s] [--crn] [--out file] [--trace file]" << endl;
+}
+
+static vector<string> splitList(const string &list) {
+    vector<string> items;
+    stringstream ss(list);
+    string item;
+    while (getline(ss, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+    string targetPath = argv[1];
+    vector<string> columns = {"Population", "Unemployment", "GDPperCapita"};
+    vector<string> names = {"offeredPriceMean", "perceivedPriceMean", "pQuit", "employeeEfficiency"};
+    bool moments = false;
+    int threads = static_cast<int>(max(1u, thread::hardware_concurrency()));
+    int iterations = 60;
+    double tolerance = 1e-3;
+    int checkpoints = 4;
+    int fishers = 100;
+    unsigned int seed = 1;
+    bool common = false;
+    string outPath = "calibration_best.csv";
+    string tracePath = "calibration_trace.csv";
+
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--columns" && i + 1 < argc) {
+            columns = splitList(argv[++i]);
+        } else if (arg == "--params" && i + 1 < argc) {
+            names = splitList(argv[++i]);
+        } else if (arg == "--moments") {
+            moments = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = max(1, atoi(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = max(0, atoi(argv[++i]));
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else if (arg == "--checkpoints" && i + 1 < argc) {
+            checkpoints = max(0, atoi(argv[++i]));
+        } else if (arg == "--fishers" && i + 1 < argc) {
+            fishers = max(1, atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--crn") {
+            common = true;
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    // Parameters and their bounds (name or name=lo:hi).
+    vector<CalibratedParameter> parameters;
+    for (const auto &spec : names) {
+        size_t eq = spec.find('=');
+        string name = spec.substr(0, eq);
+        auto &all = calibratableParameters();
+        auto it = find_if(all.begin(), all.end(), [&](const CalibratedParameter &p) { return p.name == name; });
+        if (it == all.end()) {
+            cerr << "Error: Parameter " << name << " cannot be calibrated" << endl;
+            return 1;
+        }
+        CalibratedParameter par = *it;
+        if (eq != string::npos) {
+            size_t colon = spec.find(':', eq);
+            if (colon == string::npos) {
+                usage();
+                return 1;
+            }
+            par.lower = atof(spec.substr(eq + 1, colon - eq - 1).c_str());
+            par.upper = atof(spec.substr(colon + 1).c_str());
+        }
+        parameters.push_back(par);
+    }
+
+    CalibrationTarget target;
+    if (!target.load(targetPath, columns))
+        return 1;
+
+    // Concurrent candidates would share rand(), so their losses, and with them the
+    // simplex's path, would change from run to run.
+    if (threads > 1)
+        common = true;
+
+    SimulationParameters base;
+    base.seed = seed;
+    base.commonRandomNumbers = common;
+    base.outputPath = "";
+    base.totalFisherMen = fishers;
+    base.totalFirms = max(1, static_cast<int>(0.08 * fishers));
+    base.initialEmployed = static_cast<int>(0.90 * fishers);
+    base.totalJobOffers = static_cast<int>(0.10 * fishers);
+
+    cout << "calibrating " << parameters.size() << " parameters against " << target.columns.size()
+         << " columns x " << target.days() << " days (" << (moments ? "moments" : "series")
+         << ", " << threads << " threads" << (common ? ", common random numbers" : "") << ")" << endl;
+    auto start = chrono::high_resolution_clock::now();
+    Calibrator calibrator(base, target, parameters, moments, threads, checkpoints);
+    calibrator.run(iterations, tolerance);
+    chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+
+    vector<double> best = calibrator.getBest();
+    for (size_t k = 0; k < parameters.size(); k++)
+        cout << "   " << parameters[k].name << " = " << best[k] << endl;
+    cout << "   loss = " << calibrator.getBestLoss() << " after " << calibrator.getEvaluations()
+         << " runs (" << calibrator.getStopped() << " stopped early) in " << elapsed.count()
+         << " seconds" << endl;
+    bool ok = calibrator.writeBest(outPath);
+    ok = calibrator.writeTrace(tracePath) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+// Cross-run query over a run catalog (see Metrics/Catalog.h).
+//
+//   query.exe <catalog> <column> [options]
+//     --where name=lo:hi   keep runs whose parameter lies in [lo, hi] (repeatable)
+//     --quantiles a,b,...  quantile bands to compute (default 0.1,0.5,0.9)
+//     --threads n          scanning threads (default: all cores)
+//     --out file           result file (default: standard output)
+//     --list               list the matching runs instead
+//
+// The result has one row per cycle: Cycle, Runs, Mean and one column per quantile
+// (e.g. Q10, Q50, Q90), ready for python/show.py.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include "Catalog.h"
+
+using namespace std;
+
+struct Filter {
+    string name;
+    double lo, hi;
+};
+
+static void usage() {
+    cerr << "usage: query.exe <catalog> <column> [--where name=lo:hi] [--quantiles 0.1,0.5,0.9]"
+         << " [--threads n] [--out file] [--list]" << endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    string catalogPath = argv[1];
+    string column = argv[2];
+    vector<Filter> filters;
+    vector<double> quantiles = {0.1, 0.5, 0.9};
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    string outPath;
+    bool list = false;
+
+    for (int i = 3; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--where" && i + 1 < argc) {
+            string w = argv[++i];
+            size_t eq = w.find('='), colon = w.find(':');
+            if (eq == string::npos || colon == string::npos || colon < eq) {
+                usage();
+                return 1;
+            }
+            filters.push_back({w.substr(0, eq), atof(w.substr(eq + 1, colon - eq - 1).c_str()),
+                               atof(w.substr(colon + 1).c_str())});
+        } else if (arg == "--quantiles" && i + 1 < argc) {
+            quantiles.clear();
+            stringstream ss(argv[++i]);
+            string q;
+            while (getline(ss, q, ','))
+                quantiles.push_back(atof(q.c_str()));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(max(1, atoi(argv[++i])));
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    CatalogView catalog(catalogPath);
+    if (!catalog.isOpen()) {
+        cerr << "Error: Unable to open catalog " << catalogPath << endl;
+        return 1;
+    }
+
+    // Select the runs: only headers and parameters are read here.
+    vector<const double *> series;
+    vector<size_t> lengths;
+    size_t cycles = 0;
+    for (const auto &run : catalog.getRuns()) {
+        bool keep = true;
+        for (const auto &f : filters) {
+            if (!run.hasParameter(f.name)) {
+                keep = false;
+                break;
+            }
+            double v = run.parameter(f.name);
+            if (v < f.lo || v > f.hi) {
+                keep = false;
+                break;
+            }
+        }
+        const double *values = keep ? run.column(column) : nullptr;
+        if (!values)
+            continue;
+        if (list) {
+            cout << run.getLabel() << "  seed=" << run.header->seed << "  cycles=" << run.header->cycles;
+            for (uint32_t p = 0; p < run.header->parameters; p++)
+                cout << "  " << run.parameters[p].name << "=" << run.parameters[p].value;
+            cout << "\n";
+        }
+        series.push_back(values);
+        lengths.push_back(run.header->cycles);
+        cycles = max(cycles, static_cast<size_t>(run.header->cycles));
+    }
+    if (list)
+        return 0;
+    cerr << series.size() << " of " << catalog.getRuns().size() << " runs selected" << endl;
+
+    // Parallel scan: each thread owns a contiguous block of cycles and reads, run by
+    // run, the slice of every metric block that falls in it.
+    const size_t nq = quantiles.size();
+    const size_t stride = 2 + nq;  // runs, mean, quantiles
+    vector<double> result(cycles * stride, 0.0);
+    auto scan = [&](size_t begin, size_t end) {
+        const size_t block = 256;
+        vector<double> values;
+        vector<vector<double>> slice;
+        for (size_t c0 = begin; c0 < end; c0 += block) {
+            size_t c1 = min(end, c0 + block);
+            slice.assign(c1 - c0, vector<double>());
+            for (size_t r = 0; r < series.size(); r++) {
+                size_t stop = min(c1, lengths[r]);
+                for (size_t c = c0; c < stop; c++)
+                    slice[c - c0].push_back(series[r][c]);
+            }
+            for (size_t c = c0; c < c1; c++) {
+                values.swap(slice[c - c0]);
+                double *row = &result[c * stride];
+                row[0] = static_cast<double>(values.size());
+                if (values.empty())
+                    continue;
+                double sum = 0.0;
+                for (double v : values)
+                    sum += v;
+                row[1] = sum / static_cast<double>(values.size());
+                for (size_t q = 0; q < nq; q++) {
+                    double pos = min(max(quantiles[q], 0.0), 1.0) * static_cast<double>(values.size() - 1);
+                    size_t k = static_cast<size_t>(pos);
+                    nth_element(values.begin(), values.begin() + static_cast<long>(k), values.end());
+                    double lo = values[k];
+                    double hi = lo;
+                    if (k + 1 < values.size())
+                        hi = *min_element(values.begin() + static_cast<long>(k) + 1, values.end());
+                    row[2 + q] = lo + (pos - static_cast<double>(k)) * (hi - lo);
+                }
+            }
+        }
+    };
+    vector<thread> workers;
+    threads = static_cast<unsigned>(min<size_t>(threads, max<size_t>(cycles, 1)));
+    for (unsigned t = 1; t < threads; t++)
+        workers.emplace_back(scan, cycles * t / threads, cycles * (t + 1) / threads);
+    scan(0, cycles / threads);
+    for (auto &w : workers)
+        w.join();
+
+    ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath);
+        if (!file.is_open()) {
+            cerr << "Error: Unable to open " << outPath << endl;
+            return 1;
+        }
+    }
+    ostream &out = outPath.empty() ? cout : file;
+    out << "Cycle,Runs,Mean";
+    for (double q : quantiles)
+        out << ",Q" << round(q * 100);
+    out << "\n";
+    for (size_t c = 0; c < cycles; c++) {
+        const double *row = &result[c * stride];
+        out << c + 1 << "," << row[0];
+        for (size_t k = 1; k < stride; k++)
+            out << "," << row[k];
+        out << "\n";
+    }
+    return 0;
+}
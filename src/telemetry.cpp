@@ -0,0 +1,81 @@
+// Tail the live telemetry of a running simulation (see Metrics/Telemetry.h).
+//
+//   telemetry.exe <segment> [--interval ms] [--from-start]
+//
+// Prints the header line, then one CSV row per published cycle until the run
+// finishes. By default only new records are shown; --from-start replays what is
+// still in the ring. Records overwritten before they could be read are reported.
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include "Telemetry.h"
+
+using namespace std;
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "usage: telemetry.exe <segment> [--interval ms] [--from-start]" << endl;
+        return 1;
+    }
+    string segment = argv[1];
+    int intervalMs = 100;
+    bool fromStart = false;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--interval" && i + 1 < argc)
+            intervalMs = max(1, atoi(argv[++i]));
+        else if (arg == "--from-start")
+            fromStart = true;
+    }
+
+    // Wait for the run to create its segment.
+    unique_ptr<TelemetryReader> reader;
+    for (int attempt = 0; attempt < 600; attempt++) {
+        reader.reset(new TelemetryReader(segment));
+        if (reader->isOpen())
+            break;
+        this_thread::sleep_for(chrono::milliseconds(intervalMs));
+    }
+    if (!reader->isOpen()) {
+        cerr << "Error: No telemetry segment " << segment << endl;
+        return 1;
+    }
+
+    vector<string> fields = reader->fields();
+    for (size_t f = 0; f < fields.size(); f++)
+        cout << (f ? "," : "") << fields[f];
+    cout << endl;
+
+    uint64_t next = reader->published();
+    if (fromStart)
+        next = next > reader->capacity() ? next - reader->capacity() : 0;
+    vector<double> values;
+    for (;;) {
+        bool done = reader->finished();
+        uint64_t available = reader->published();
+        for (; next < available; next++) {
+            if (!reader->read(next, values)) {
+                // Overwritten: jump to the oldest record still in the ring.
+                uint64_t oldest = reader->published();
+                oldest = oldest > reader->capacity() ? oldest - reader->capacity() + 1 : 0;
+                if (oldest > next) {
+                    cerr << "skipped " << oldest - next << " records" << endl;
+                    next = oldest - 1;
+                }
+                continue;
+            }
+            for (size_t f = 0; f < values.size(); f++)
+                cout << (f ? "," : "") << values[f];
+            cout << "\n";
+        }
+        cout.flush();
+        if (done)
+            break;
+        this_thread::sleep_for(chrono::milliseconds(intervalMs));
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+// Golden-trace record and replay (see World/GoldenTrace.h).
+//
+//   trace.exe record <trace> [options]
+//     --days n              days to simulate (default 300)
+//     --fishers n           initial population (default 100; firms, jobs and employment scale with it)
+//     --seed s              seed (default 1)
+//     --crn                 common random numbers (needed to replay with rand()-free draws)
+//     --set name=value,...  model settings of the reference run (see setParameter)
+//     --block n             rows per digest block (default 4096)
+//     --threads n           digest threads (default 1)
+//
+//   trace.exe replay <trace> [options]
+//     --engine name=value,...  engine configuration to check (e.g. marketThreads=4)
+//     --tolerance rel[:abs]    compare column sums within a tolerance instead of hashes
+//     --threads n              digest threads (default 1)
+//
+// Replay reruns the recorded settings with the engine changes and stops at the first
+// diverging cycle; it then reruns the reference to that point to name the first
+// differing row. Exit status: 0 identical, 2 diverged, 1 error.
+//
+// Without --crn the turnover draws come from the process-wide rand(), which is only
+// reproducible for one run per process, as here.
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include "Calibration.h"
+#include "GoldenTrace.h"
+
+using namespace std;
+
+static void usage() {
+    cerr << "usage: trace.exe record <trace> [--days n] [--fishers n] [--seed s] [--crn] [--set name=value,...]"
+         << " [--block n] [--threads n]" << endl
+         << "       trace.exe replay <trace> [--engine name=value,...] [--tolerance rel[:abs]] [--threads n]" << endl;
+}
+
+static SimulationParameters traceParameters(const TraceHeader &h) {
+    SimulationParameters p;
+    p.seed = h.seed;
+    p.outputPath = "";
+    p.totalCycles = static_cast<int>(h.days);
+    p.totalFisherMen = static_cast<int>(h.fishers);
+    p.totalFirms = max(1, static_cast<int>(0.08 * h.fishers));
+    p.initialEmployed = static_cast<int>(0.90 * h.fishers);
+    p.totalJobOffers = static_cast<int>(0.10 * h.fishers);
+    p.commonRandomNumbers = h.commonRandomNumbers != 0;
+    return p;
+}
+
+// Run p to the end (or to the first divergence) with an observer attached.
+static void runObserved(const SimulationParameters &p, CycleObserver &observer, const TraceRecorder *stopOn) {
+    srand(1);
+    Simulation sim(p);
+    sim.getWorld().setObserver(&observer);
+    while (!sim.finished() && !(stopOn && stopOn->diverged()))
+        sim.advance();
+    sim.getWorld().setObserver(nullptr);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    string mode = argv[1];
+    string path = argv[2];
+    TraceHeader header;
+    header.seed = 1;
+    header.fishers = 100;
+    header.days = 300;
+    string settings, engine;
+    double rel = -1.0, abs = 0.0;
+    int threads = 1;
+
+    for (int i = 3; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--days" && i + 1 < argc) {
+            header.days = static_cast<uint32_t>(max(1, atoi(argv[++i])));
+        } else if (arg == "--fishers" && i + 1 < argc) {
+            header.fishers = static_cast<uint32_t>(max(1, atoi(argv[++i])));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            header.seed = static_cast<uint32_t>(max(1ul, strtoul(argv[++i], nullptr, 10)));
+        } else if (arg == "--crn") {
+            header.commonRandomNumbers = 1;
+        } else if (arg == "--set" && i + 1 < argc) {
+            settings = argv[++i];
+        } else if (arg == "--block" && i + 1 < argc) {
+            header.blockSize = static_cast<uint32_t>(max(1, atoi(argv[++i])));
+        } else if (arg == "--engine" && i + 1 < argc) {
+            engine = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            string t = argv[++i];
+            size_t colon = t.find(':');
+            rel = atof(t.substr(0, colon).c_str());
+            abs = colon == string::npos ? 0.0 : atof(t.substr(colon + 1).c_str());
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = max(1, atoi(argv[++i]));
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+    if (mode == "record") {
+        SimulationParameters p = traceParameters(header);
+        if (!applyParameterChanges(p, settings))
+            return 1;
+        TraceRecorder recorder(path, header, settings, threads);
+        if (!recorder.isOpen())
+            return 1;
+        runObserved(p, recorder, nullptr);
+        chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+        cout << "recorded " << recorder.getCompared() << " table digests over " << header.days << " days in "
+             << elapsed.count() << " seconds" << endl;
+        return 0;
+    }
+    if (mode != "replay") {
+        usage();
+        return 1;
+    }
+
+    TraceRecorder replay(path, rel, abs, threads);
+    if (!replay.isOpen() || !replay.readHeader(header, settings))
+        return 1;
+    SimulationParameters reference = traceParameters(header);
+    if (!applyParameterChanges(reference, settings))
+        return 1;
+    SimulationParameters candidate = reference;
+    if (!applyParameterChanges(candidate, engine))
+        return 1;
+    runObserved(candidate, replay, &replay);
+    chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+
+    if (!replay.diverged() && replay.atEnd()) {
+        cout << "identical to the trace (" << (rel < 0.0 ? "exact" : "within tolerance") << "): "
+             << replay.getCompared() << " table digests over " << header.days << " days in "
+             << elapsed.count() << " seconds" << endl;
+        return 0;
+    }
+    if (!replay.diverged()) {
+        cout << "diverged: the run ends before the trace" << endl;
+        return 2;
+    }
+
+    const TraceDivergence &d = replay.getDivergence();
+    const TraceTableSpec &table = traceTables()[d.table];
+    cout << "diverged at cycle " << d.cycle + 1 << ", phase " << cyclePhaseName(table.phase)
+         << ", table " << table.name << ": " << d.reason << endl;
+    if (d.reason != "digest mismatch")
+        return 2;
+    size_t blockSize = replay.getBlockSize();
+    cout << "   block " << d.block << " (rows " << d.block * blockSize << "-" << (d.block + 1) * blockSize - 1 << ")";
+    if (d.column >= 0)
+        cout << ", column " << table.columns[d.column] << ": sum " << d.reference << " (reference) vs "
+             << d.candidate << " (replay)";
+    cout << endl;
+
+    // Rerun the reference to the diverging cycle and compare the block row by row.
+    BlockCapture capture(d.cycle, d.table, d.block, blockSize);
+    {
+        srand(1);
+        Simulation sim(reference);
+        sim.getWorld().setObserver(&capture);
+        while (!sim.finished() && !capture.captured)
+            sim.advance();
+        sim.getWorld().setObserver(nullptr);
+    }
+    size_t rows = min(capture.rows.empty() ? 0 : capture.rows[0].size(), d.rows.empty() ? 0 : d.rows[0].size());
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t c = 0; c < table.columns.size(); c++) {
+            double a = capture.rows[c][r], b = d.rows[c][r];
+            bool close = rel < 0.0 ? a == b : fabs(a - b) <= abs + rel * max(fabs(a), fabs(b));
+            if (close)
+                continue;
+            size_t row = d.block * blockSize + r;
+            cout << "   first difference: row " << row;
+            if (string(table.columns[0]) == "id")
+                cout << " (agent " << capture.rows[0][r] << ")";
+            else if (string(table.name) == "orders")
+                cout << " (order of the fisherman at position " << row << ")";
+            cout << ", " << table.columns[c] << " = " << a << " (reference) vs " << b << " (replay)" << endl;
+            return 2;
+        }
+    }
+    if (capture.rows.empty() || d.rows.empty() || capture.rows[0].size() != d.rows[0].size())
+        cout << "   the block has " << (capture.rows.empty() ? 0 : capture.rows[0].size()) << " rows in the reference and "
+             << (d.rows.empty() ? 0 : d.rows[0].size()) << " in the replay" << endl;
+    else
+        cout << "   the rerun reference matches the replay here: the difference comes from this build"
+             << " (compile-time switches such as FIXED_MONEY, or changed code), not from the engine settings" << endl;
+    return 2;
+}